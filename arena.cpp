@@ -0,0 +1,13 @@
+#include "arena.hpp"
+
+#include <memory>
+#include <memory_resource>
+
+grechin::ArenaPointer grechin::makeArena(const size_t initialSize)
+{
+  if (initialSize == 0)
+  {
+    return std::make_shared<std::pmr::monotonic_buffer_resource>();
+  }
+  return std::make_shared<std::pmr::monotonic_buffer_resource>(initialSize);
+}
@@ -0,0 +1,79 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+namespace grechin
+{
+  typedef std::shared_ptr<std::pmr::memory_resource> ArenaPointer;
+
+  ArenaPointer makeArena(const size_t = 0);
+
+  template <typename T>
+  class ArenaAllocator
+  {
+  public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(const ArenaPointer&);
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>&) noexcept;
+
+    T* allocate(const size_t);
+    void deallocate(T*, const size_t);
+    const ArenaPointer& getArena() const;
+
+  private:
+    ArenaPointer arena_;
+  };
+
+  template <typename T, typename U>
+  bool operator==(const ArenaAllocator<T>&, const ArenaAllocator<U>&);
+  template <typename T, typename U>
+  bool operator!=(const ArenaAllocator<T>&, const ArenaAllocator<U>&);
+}
+
+template <typename T>
+grechin::ArenaAllocator<T>::ArenaAllocator(const ArenaPointer& arena) :
+  arena_(arena)
+{}
+
+template <typename T>
+template <typename U>
+grechin::ArenaAllocator<T>::ArenaAllocator(const ArenaAllocator<U>& allocator) noexcept :
+  arena_(allocator.getArena())
+{}
+
+template <typename T>
+T* grechin::ArenaAllocator<T>::allocate(const size_t count)
+{
+  return static_cast<T*>(arena_->allocate(count * sizeof(T), alignof(T)));
+}
+
+template <typename T>
+void grechin::ArenaAllocator<T>::deallocate(T* pointer, const size_t count)
+{
+  arena_->deallocate(pointer, count * sizeof(T), alignof(T));
+}
+
+template <typename T>
+const grechin::ArenaPointer& grechin::ArenaAllocator<T>::getArena() const
+{
+  return arena_;
+}
+
+template <typename T, typename U>
+bool grechin::operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs)
+{
+  return lhs.getArena() == rhs.getArena();
+}
+
+template <typename T, typename U>
+bool grechin::operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+#endif
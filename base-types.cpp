@@ -4,13 +4,45 @@
 
 #include <cmath>
 
-void addition::revolve(grechin::point_t& shapeCenter, const grechin::point_t& center, const double angle)
+std::atomic<bool> addition::edited(false);
+
+grechin::rotation_t addition::getRotation(const double angle)
 {
+  const double normalized = fmod(angle, 360);
+  if (normalized == 0)
+  {
+    return { 1, 0 };
+  }
+  if (normalized == 90 || normalized == -270)
+  {
+    return { 0, 1 };
+  }
+  if (normalized == 180 || normalized == -180)
+  {
+    return { -1, 0 };
+  }
+  if (normalized == 270 || normalized == -90)
+  {
+    return { 0, -1 };
+  }
   const double radAngle = angle * M_PI / 180;
+  return { cos(radAngle), sin(radAngle) };
+}
+
+void addition::revolve(grechin::point_t& shapeCenter, const grechin::point_t& center, const double angle)
+{
+  revolve(shapeCenter, center, getRotation(angle));
+}
+
+void addition::revolve(grechin::point_t& shapeCenter, const grechin::point_t& center,
+    const grechin::rotation_t& rotation)
+{
+  const double cosAngle = fabs(rotation.cos);
+  const double sinAngle = fabs(rotation.sin);
   const double xTemp = shapeCenter.x - center.x;
   const double yTemp = shapeCenter.y - center.y;
-  shapeCenter.x = xTemp * fabs(cos(radAngle)) - yTemp * fabs(sin(radAngle)) + center.x;
-  shapeCenter.y = xTemp * fabs(sin(radAngle)) + yTemp * fabs(cos(radAngle)) + center.y;
+  shapeCenter.x = xTemp * cosAngle - yTemp * sinAngle + center.x;
+  shapeCenter.y = xTemp * sinAngle + yTemp * cosAngle + center.y;
 }
 
 bool addition::isOverlapped(const grechin::rectangle_t& firFrame, const grechin::rectangle_t& secFrame)
@@ -1,6 +1,8 @@
 #ifndef BASE_TYPES_HPP
 #define BASE_TYPES_HPP
 
+#include <atomic>
+
 namespace grechin
 {
   struct point_t
@@ -15,12 +17,32 @@ namespace grechin
     double height;
     point_t pos;
   };
+
+  struct rotation_t
+  {
+    double cos;
+    double sin;
+  };
 }
 
 namespace addition
 {
+  grechin::rotation_t getRotation(const double);
   void revolve(grechin::point_t&, const grechin::point_t&, const double);
+  void revolve(grechin::point_t&, const grechin::point_t&, const grechin::rotation_t&);
   bool isOverlapped(const grechin::rectangle_t&, const grechin::rectangle_t&);
+
+  extern std::atomic<bool> edited;
+  void markEdited();
+}
+
+inline void addition::markEdited()
+{
+  // Read first, so shapes edited from many threads stop writing the shared flag once it is raised
+  if (!edited.load(std::memory_order_relaxed))
+  {
+    edited.store(true, std::memory_order_relaxed);
+  }
 }
 
 #endif 
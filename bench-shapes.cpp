@@ -0,0 +1,1138 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "composite-shape.hpp"
+#include "concurrent-composite-shape.hpp"
+#include "ingest-buffer.hpp"
+#include "serialization.hpp"
+#include "flat-composite.hpp"
+#include "mapped-scene.hpp"
+#include "shape-store.hpp"
+#include "text-import.hpp"
+#include "broad-phase.hpp"
+#include "narrow-phase.hpp"
+#include "raster.hpp"
+#include "base-types.hpp"
+
+namespace
+{
+  std::atomic<size_t> allocationCount(0);
+  std::atomic<size_t> allocationBytes(0);
+
+  struct allocation_t
+  {
+    size_t count;
+    size_t bytes;
+  };
+
+  allocation_t getAllocations()
+  {
+    return { allocationCount.load(std::memory_order_relaxed), allocationBytes.load(std::memory_order_relaxed) };
+  }
+
+  void* allocate(const size_t size)
+  {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    void* pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer == nullptr)
+    {
+      throw std::bad_alloc();
+    }
+    return pointer;
+  }
+
+  long getMaxChildren()
+  {
+    const char* value = std::getenv("GRECHIN_BENCH_MAX_CHILDREN");
+    if (value == nullptr)
+    {
+      return 10000000;
+    }
+    const long result = std::atol(value);
+    return result < 10 ? 10 : result;
+  }
+
+  void applySizes(benchmark::internal::Benchmark* benchmark)
+  {
+    const long maxChildren = getMaxChildren();
+    for (long size = 10; size <= maxChildren; size *= 10)
+    {
+      benchmark->Arg(size);
+    }
+  }
+
+  void applyPolicies(benchmark::internal::Benchmark* benchmark)
+  {
+    const long maxChildren = getMaxChildren();
+    for (long size = 10; size <= maxChildren; size *= 10)
+    {
+      benchmark->Args({ size, 0 });
+      benchmark->Args({ size, 1 });
+    }
+  }
+
+  void applyDepths(benchmark::internal::Benchmark* benchmark)
+  {
+    for (long depth = 4; depth <= 1024; depth *= 4)
+    {
+      benchmark->Arg(depth);
+    }
+  }
+
+  std::shared_ptr<grechin::Shape> makeChild(std::mt19937& generator, const size_t index)
+  {
+    std::uniform_real_distribution<double> size(0.5, 4);
+    std::uniform_real_distribution<double> coordinate(-1000, 1000);
+    const grechin::point_t center = { coordinate(generator), coordinate(generator) };
+    if (index % 2 == 0)
+    {
+      return std::make_shared<grechin::Circle>(size(generator), center);
+    }
+    return std::make_shared<grechin::Rectangle>(size(generator), size(generator), center, index % 90);
+  }
+
+  grechin::CompositeShape makeFlat(const size_t count)
+  {
+    std::mt19937 generator(42);
+    grechin::CompositeShape composite;
+    composite.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+      composite.add(makeChild(generator, i));
+    }
+    return composite;
+  }
+
+  std::vector<std::shared_ptr<grechin::Shape>> makeShapes(const size_t count)
+  {
+    std::mt19937 generator(42);
+    std::vector<std::shared_ptr<grechin::Shape>> shapes;
+    shapes.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+      shapes.push_back(makeChild(generator, i));
+    }
+    return shapes;
+  }
+
+  std::vector<grechin::ShapeValue> makeValues(const size_t count)
+  {
+    const grechin::FlatComposite flat(makeFlat(count));
+    std::vector<grechin::ShapeValue> shapes;
+    shapes.reserve(flat.getSize());
+    for (size_t i = 0; i < flat.getSize(); i++)
+    {
+      shapes.push_back(flat[i]);
+    }
+    return shapes;
+  }
+
+  // Visitors over flat storage. The inlined ones call the bodies in circle.hpp and rectangle.hpp; the outlined ones
+  // call the same bodies through pointers the compiler cannot follow, as if they lived in circle.cpp and rectangle.cpp
+  struct inlined_area_t
+  {
+    double operator()(const grechin::Circle& circle) const
+    {
+      return circle.grechin::Circle::getArea();
+    }
+
+    double operator()(const grechin::Rectangle& rectangle) const
+    {
+      return rectangle.grechin::Rectangle::getArea();
+    }
+
+    double operator()(const std::shared_ptr<grechin::CompositeShape>&) const
+    {
+      return 0;
+    }
+  };
+
+  struct outlined_area_t
+  {
+    double (*circleArea)(const grechin::Circle&);
+    double (*rectangleArea)(const grechin::Rectangle&);
+
+    double operator()(const grechin::Circle& circle) const
+    {
+      return circleArea(circle);
+    }
+
+    double operator()(const grechin::Rectangle& rectangle) const
+    {
+      return rectangleArea(rectangle);
+    }
+
+    double operator()(const std::shared_ptr<grechin::CompositeShape>&) const
+    {
+      return 0;
+    }
+  };
+
+  struct inlined_frame_t
+  {
+    grechin::rectangle_t operator()(const grechin::Circle& circle) const
+    {
+      return circle.grechin::Circle::getFrameRect();
+    }
+
+    grechin::rectangle_t operator()(const grechin::Rectangle& rectangle) const
+    {
+      return rectangle.grechin::Rectangle::getFrameRect();
+    }
+
+    grechin::rectangle_t operator()(const std::shared_ptr<grechin::CompositeShape>&) const
+    {
+      return grechin::rectangle_t{ 0, 0, { 0, 0 } };
+    }
+  };
+
+  struct outlined_frame_t
+  {
+    grechin::rectangle_t (*circleFrame)(const grechin::Circle&);
+    grechin::rectangle_t (*rectangleFrame)(const grechin::Rectangle&);
+
+    grechin::rectangle_t operator()(const grechin::Circle& circle) const
+    {
+      return circleFrame(circle);
+    }
+
+    grechin::rectangle_t operator()(const grechin::Rectangle& rectangle) const
+    {
+      return rectangleFrame(rectangle);
+    }
+
+    grechin::rectangle_t operator()(const std::shared_ptr<grechin::CompositeShape>&) const
+    {
+      return grechin::rectangle_t{ 0, 0, { 0, 0 } };
+    }
+  };
+
+  outlined_area_t makeOutlinedArea()
+  {
+    outlined_area_t visitor = {
+      [](const grechin::Circle& circle) { return circle.grechin::Circle::getArea(); },
+      [](const grechin::Rectangle& rectangle) { return rectangle.grechin::Rectangle::getArea(); }
+    };
+    benchmark::DoNotOptimize(visitor);
+    return visitor;
+  }
+
+  outlined_frame_t makeOutlinedFrame()
+  {
+    outlined_frame_t visitor = {
+      [](const grechin::Circle& circle) { return circle.grechin::Circle::getFrameRect(); },
+      [](const grechin::Rectangle& rectangle) { return rectangle.grechin::Rectangle::getFrameRect(); }
+    };
+    benchmark::DoNotOptimize(visitor);
+    return visitor;
+  }
+
+  template <typename Visitor>
+  double sumAreas(const std::vector<grechin::ShapeValue>& shapes, const Visitor& visitor)
+  {
+    double area = 0;
+    for (const grechin::ShapeValue& shape : shapes)
+    {
+      area += std::visit(visitor, shape);
+    }
+    return area;
+  }
+
+  template <typename Visitor>
+  grechin::rectangle_t uniteFrames(const std::vector<grechin::ShapeValue>& shapes, const Visitor& visitor)
+  {
+    double xMin = std::numeric_limits<double>::max();
+    double yMin = std::numeric_limits<double>::max();
+    double xMax = std::numeric_limits<double>::lowest();
+    double yMax = std::numeric_limits<double>::lowest();
+    for (const grechin::ShapeValue& shape : shapes)
+    {
+      const grechin::rectangle_t frame = std::visit(visitor, shape);
+      xMin = std::min(xMin, frame.pos.x - frame.width / 2);
+      yMin = std::min(yMin, frame.pos.y - frame.height / 2);
+      xMax = std::max(xMax, frame.pos.x + frame.width / 2);
+      yMax = std::max(yMax, frame.pos.y + frame.height / 2);
+    }
+    return grechin::rectangle_t{ xMax - xMin, yMax - yMin, { (xMax + xMin) / 2, (yMax + yMin) / 2 } };
+  }
+
+  grechin::CompositeShape makeDense(const size_t count)
+  {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> size(0.5, 4);
+    std::uniform_real_distribution<double> coordinate(-std::sqrt(count), std::sqrt(count));
+    std::uniform_real_distribution<double> angle(0, 180);
+    grechin::CompositeShape composite;
+    composite.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+      const grechin::point_t center = { 2 * coordinate(generator), 2 * coordinate(generator) };
+      if (i % 2 == 0)
+      {
+        composite.add(std::make_shared<grechin::Circle>(size(generator) / 2, center));
+      }
+      else
+      {
+        composite.add(std::make_shared<grechin::Rectangle>(size(generator), size(generator), center, angle(generator)));
+      }
+    }
+    return composite;
+  }
+
+  std::string makeText(const size_t count)
+  {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> size(0.1, 10);
+    std::uniform_real_distribution<double> position(-1000, 1000);
+    std::ostringstream out;
+    for (size_t i = 0; i < count; i++)
+    {
+      if (i % 2 == 0)
+      {
+        out << "CIRCLE " << size(generator) << ' ' << position(generator) << ' ' << position(generator) << '\n';
+      }
+      else
+      {
+        out << "RECTANGLE " << size(generator) << ' ' << size(generator) << ' ' << position(generator) << ' '
+            << position(generator) << ' ' << 30 << '\n';
+      }
+    }
+    return out.str();
+  }
+
+  std::shared_ptr<grechin::CompositeShape> makeNested(const size_t depth)
+  {
+    std::mt19937 generator(42);
+    std::shared_ptr<grechin::CompositeShape> composite = std::make_shared<grechin::CompositeShape>();
+    composite->add(makeChild(generator, 0));
+    for (size_t level = 1; level < depth; level++)
+    {
+      std::shared_ptr<grechin::CompositeShape> parent = std::make_shared<grechin::CompositeShape>();
+      parent->add(makeChild(generator, level));
+      parent->add(composite);
+      composite = parent;
+    }
+    return composite;
+  }
+
+  void setAllocationCounters(benchmark::State& state, const allocation_t& before)
+  {
+    const allocation_t after = getAllocations();
+    state.counters["allocs/op"] = benchmark::Counter(after.count - before.count, benchmark::Counter::kAvgIterations);
+    state.counters["bytes/op"] = benchmark::Counter(after.bytes - before.bytes, benchmark::Counter::kAvgIterations);
+  }
+
+  void setChildCounters(benchmark::State& state, const size_t children, const allocation_t& before)
+  {
+    const allocation_t after = getAllocations();
+    state.counters["children"] = children;
+    state.counters["bytes/child"] = static_cast<double>(after.bytes - before.bytes) / children;
+  }
+}
+
+void* operator new(size_t size)
+{
+  return allocate(size);
+}
+
+void* operator new[](size_t size)
+{
+  return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+  std::free(pointer);
+}
+
+static void circleGetArea(benchmark::State& state)
+{
+  const grechin::Circle circle(2.5, { 1, 1 });
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(circle.getArea());
+  }
+  setAllocationCounters(state, before);
+}
+BENCHMARK(circleGetArea);
+
+static void circleGetFrameRect(benchmark::State& state)
+{
+  const grechin::Circle circle(2.5, { 1, 1 });
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(circle.getFrameRect());
+  }
+  setAllocationCounters(state, before);
+}
+BENCHMARK(circleGetFrameRect);
+
+static void rectangleGetArea(benchmark::State& state)
+{
+  const grechin::Rectangle rectangle(3, 2, { 1, 1 }, 30);
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(rectangle.getArea());
+  }
+  setAllocationCounters(state, before);
+}
+BENCHMARK(rectangleGetArea);
+
+static void rectangleGetFrameRect(benchmark::State& state)
+{
+  const grechin::Rectangle rectangle(3, 2, { 1, 1 }, 30);
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(rectangle.getFrameRect());
+  }
+  setAllocationCounters(state, before);
+}
+BENCHMARK(rectangleGetFrameRect);
+
+static void rectangleRotate(benchmark::State& state)
+{
+  grechin::Rectangle rectangle(3, 2, { 1, 1 });
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    rectangle.rotate(7);
+    benchmark::ClobberMemory();
+  }
+  setAllocationCounters(state, before);
+}
+BENCHMARK(rectangleRotate);
+
+static void compositeAdd(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(makeFlat(count));
+  }
+  setAllocationCounters(state, before);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(compositeAdd)->Apply(applySizes)->Unit(benchmark::kMillisecond);
+
+static void compositeRemove(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  grechin::CompositeShape composite = makeFlat(count);
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    const std::shared_ptr<grechin::Shape> child = composite[count / 2];
+    composite.remove(count / 2);
+    state.PauseTiming();
+    composite.add(child);
+    state.ResumeTiming();
+  }
+  setAllocationCounters(state, before);
+}
+BENCHMARK(compositeRemove)->Apply(applySizes);
+
+static void compositeSwapRemove(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  grechin::CompositeShape composite = makeFlat(count);
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    const std::shared_ptr<grechin::Shape> child = composite[0];
+    composite.swapRemove(0);
+    state.PauseTiming();
+    composite.add(child);
+    state.ResumeTiming();
+  }
+  setAllocationCounters(state, before);
+}
+BENCHMARK(compositeSwapRemove)->Apply(applySizes);
+
+static void compositeRemoveIf(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    grechin::CompositeShape composite = makeFlat(count);
+    state.ResumeTiming();
+    composite.removeIf([](const std::shared_ptr<grechin::Shape>& shape)
+    {
+      return shape->getArea() < 4;
+    });
+    benchmark::DoNotOptimize(composite.getSize());
+  }
+  setAllocationCounters(state, before);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(compositeRemoveIf)->Apply(applySizes);
+
+static void compositeCopy(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  const grechin::CompositeShape composite = makeFlat(count);
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    grechin::CompositeShape copy(composite);
+    benchmark::DoNotOptimize(copy.getArea());
+  }
+  setAllocationCounters(state, before);
+}
+BENCHMARK(compositeCopy)->Apply(applySizes);
+
+static void compositeGetArea(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  const allocation_t start = getAllocations();
+  grechin::CompositeShape composite = makeFlat(count);
+  setChildCounters(state, count, start);
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(composite.getArea());
+  }
+  setAllocationCounters(state, before);
+}
+BENCHMARK(compositeGetArea)->Apply(applySizes);
+
+static void compositeRefresh(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  grechin::CompositeShape composite = makeFlat(count);
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    composite.refresh();
+    benchmark::DoNotOptimize(composite.getArea());
+  }
+  setAllocationCounters(state, before);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(compositeRefresh)->Apply(applySizes);
+
+static void compositeGetFrameRect(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  grechin::CompositeShape composite = makeFlat(count);
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(composite.getFrameRect());
+  }
+  setAllocationCounters(state, before);
+}
+BENCHMARK(compositeGetFrameRect)->Apply(applySizes);
+
+static void compositeMove(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  grechin::CompositeShape composite = makeFlat(count);
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    composite.move(0.5, -0.5);
+    benchmark::DoNotOptimize(composite.getFrameRect());
+  }
+  setAllocationCounters(state, before);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(compositeMove)->Apply(applySizes);
+
+static void compositeScale(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  grechin::CompositeShape composite = makeFlat(count);
+  double coefficient = 2;
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    composite.scale(coefficient);
+    coefficient = 1 / coefficient;
+    benchmark::DoNotOptimize(composite.getFrameRect());
+  }
+  setAllocationCounters(state, before);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(compositeScale)->Apply(applySizes);
+
+static void compositeRotate(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  grechin::CompositeShape composite = makeFlat(count);
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    composite.rotate(15);
+    benchmark::DoNotOptimize(composite.getFrameRect());
+  }
+  setAllocationCounters(state, before);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(compositeRotate)->Apply(applySizes);
+
+static void compositeSerialize(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  const grechin::CompositeShape composite = makeFlat(count);
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(grechin::serialize(composite));
+  }
+  setAllocationCounters(state, before);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(compositeSerialize)->Apply(applySizes);
+
+static void compositeDeserialize(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  const std::vector<char> buffer = grechin::serialize(makeFlat(count));
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(grechin::deserialize(buffer.data(), buffer.size()));
+  }
+  setAllocationCounters(state, before);
+  state.SetItemsProcessed(state.iterations() * count);
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(compositeDeserialize)->Apply(applySizes);
+
+static void mappedSceneGetArea(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  const char* path = "grechin-bench-scene.bin";
+  {
+    std::ofstream file(path, std::ios::binary);
+    grechin::serialize(file, makeFlat(count));
+  }
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    const grechin::MappedScene scene(path);
+    benchmark::DoNotOptimize(scene.getArea());
+  }
+  setAllocationCounters(state, before);
+  state.SetItemsProcessed(state.iterations() * count);
+  std::remove(path);
+}
+BENCHMARK(mappedSceneGetArea)->Apply(applySizes);
+
+static void textImportStore(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  const std::string text = makeText(count);
+  for (auto _ : state)
+  {
+    std::istringstream in(text);
+    grechin::ShapeStore store;
+    benchmark::DoNotOptimize(grechin::importText(in, store));
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(textImportStore)->Apply(applySizes);
+
+static void textImportComposite(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  const std::string text = makeText(count);
+  for (auto _ : state)
+  {
+    std::istringstream in(text);
+    grechin::CompositeShape composite;
+    benchmark::DoNotOptimize(grechin::importText(in, composite));
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(textImportComposite)->Apply(applySizes);
+
+static void textExtractionLoop(benchmark::State& state)
+{
+  const size_t count = state.range(0);
+  const std::string text = makeText(count);
+  for (auto _ : state)
+  {
+    std::istringstream in(text);
+    grechin::CompositeShape composite;
+    std::string type;
+    while (in >> type)
+    {
+      double width = 0;
+      double height = 0;
+      double x = 0;
+      double y = 0;
+      double angle = 0;
+      if (type == "CIRCLE" && in >> width >> x >> y)
+      {
+        composite.add(std::make_shared<grechin::Circle>(width, grechin::point_t{ x, y }));
+      }
+      else if (in >> width >> height >> x >> y >> angle)
+      {
+        composite.add(std::make_shared<grechin::Rectangle>(width, height, grechin::point_t{ x, y }, angle));
+      }
+    }
+    benchmark::DoNotOptimize(composite.getSize());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(textExtractionLoop)->Apply(applySizes);
+
+static void virtualGetArea(benchmark::State& state)
+{
+  const std::vector<std::shared_ptr<grechin::Shape>> shapes = makeShapes(state.range(0));
+  for (auto _ : state)
+  {
+    double area = 0;
+    for (const std::shared_ptr<grechin::Shape>& shape : shapes)
+    {
+      area += shape->getArea();
+    }
+    benchmark::DoNotOptimize(area);
+  }
+  state.SetItemsProcessed(state.iterations() * shapes.size());
+}
+BENCHMARK(virtualGetArea)->Apply(applySizes);
+
+static void flatGetArea(benchmark::State& state)
+{
+  const grechin::FlatComposite flat(makeFlat(state.range(0)));
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(flat.getArea());
+  }
+  state.SetItemsProcessed(state.iterations() * flat.getSize());
+}
+BENCHMARK(flatGetArea)->Apply(applySizes);
+
+static void virtualGetFrameRect(benchmark::State& state)
+{
+  const std::vector<std::shared_ptr<grechin::Shape>> shapes = makeShapes(state.range(0));
+  for (auto _ : state)
+  {
+    const grechin::rectangle_t first = shapes.front()->getFrameRect();
+    double xMin = first.pos.x - first.width / 2;
+    double yMin = first.pos.y - first.height / 2;
+    double xMax = first.pos.x + first.width / 2;
+    double yMax = first.pos.y + first.height / 2;
+    for (size_t i = 1; i < shapes.size(); i++)
+    {
+      const grechin::rectangle_t frame = shapes[i]->getFrameRect();
+      xMin = std::min(xMin, frame.pos.x - frame.width / 2);
+      yMin = std::min(yMin, frame.pos.y - frame.height / 2);
+      xMax = std::max(xMax, frame.pos.x + frame.width / 2);
+      yMax = std::max(yMax, frame.pos.y + frame.height / 2);
+    }
+    benchmark::DoNotOptimize(grechin::rectangle_t{ xMax - xMin, yMax - yMin, { (xMax + xMin) / 2, (yMax + yMin) / 2 } });
+  }
+  state.SetItemsProcessed(state.iterations() * shapes.size());
+}
+BENCHMARK(virtualGetFrameRect)->Apply(applySizes);
+
+static void flatGetFrameRect(benchmark::State& state)
+{
+  const grechin::FlatComposite flat(makeFlat(state.range(0)));
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(flat.getFrameRect());
+  }
+  state.SetItemsProcessed(state.iterations() * flat.getSize());
+}
+BENCHMARK(flatGetFrameRect)->Apply(applySizes);
+
+static void virtualMove(benchmark::State& state)
+{
+  const std::vector<std::shared_ptr<grechin::Shape>> shapes = makeShapes(state.range(0));
+  for (auto _ : state)
+  {
+    for (const std::shared_ptr<grechin::Shape>& shape : shapes)
+    {
+      shape->move(0.5, -0.5);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * shapes.size());
+}
+BENCHMARK(virtualMove)->Apply(applySizes);
+
+static void flatMove(benchmark::State& state)
+{
+  grechin::FlatComposite flat(makeFlat(state.range(0)));
+  for (auto _ : state)
+  {
+    flat.move(0.5, -0.5);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * flat.getSize());
+}
+BENCHMARK(flatMove)->Apply(applySizes);
+
+static void inlinedGetArea(benchmark::State& state)
+{
+  const std::vector<grechin::ShapeValue> shapes = makeValues(state.range(0));
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(sumAreas(shapes, inlined_area_t{}));
+  }
+  state.SetItemsProcessed(state.iterations() * shapes.size());
+}
+BENCHMARK(inlinedGetArea)->Apply(applySizes);
+
+static void outlinedGetArea(benchmark::State& state)
+{
+  const std::vector<grechin::ShapeValue> shapes = makeValues(state.range(0));
+  const outlined_area_t visitor = makeOutlinedArea();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(sumAreas(shapes, visitor));
+  }
+  state.SetItemsProcessed(state.iterations() * shapes.size());
+}
+BENCHMARK(outlinedGetArea)->Apply(applySizes);
+
+static void inlinedGetFrameRect(benchmark::State& state)
+{
+  const std::vector<grechin::ShapeValue> shapes = makeValues(state.range(0));
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(uniteFrames(shapes, inlined_frame_t{}));
+  }
+  state.SetItemsProcessed(state.iterations() * shapes.size());
+}
+BENCHMARK(inlinedGetFrameRect)->Apply(applySizes);
+
+static void outlinedGetFrameRect(benchmark::State& state)
+{
+  const std::vector<grechin::ShapeValue> shapes = makeValues(state.range(0));
+  const outlined_frame_t visitor = makeOutlinedFrame();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(uniteFrames(shapes, visitor));
+  }
+  state.SetItemsProcessed(state.iterations() * shapes.size());
+}
+BENCHMARK(outlinedGetFrameRect)->Apply(applySizes);
+
+static void nestedGetArea(benchmark::State& state)
+{
+  const size_t depth = state.range(0);
+  const allocation_t start = getAllocations();
+  const std::shared_ptr<grechin::CompositeShape> composite = makeNested(depth);
+  setChildCounters(state, 2 * depth - 1, start);
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(composite->getArea());
+  }
+  setAllocationCounters(state, before);
+}
+BENCHMARK(nestedGetArea)->Apply(applyDepths);
+
+static void nestedGetFrameRect(benchmark::State& state)
+{
+  const std::shared_ptr<grechin::CompositeShape> composite = makeNested(state.range(0));
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(composite->getFrameRect());
+  }
+  setAllocationCounters(state, before);
+}
+BENCHMARK(nestedGetFrameRect)->Apply(applyDepths);
+
+static void nestedMove(benchmark::State& state)
+{
+  const std::shared_ptr<grechin::CompositeShape> composite = makeNested(state.range(0));
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    composite->move(0.5, -0.5);
+    benchmark::DoNotOptimize(composite->getFrameRect());
+  }
+  setAllocationCounters(state, before);
+}
+BENCHMARK(nestedMove)->Apply(applyDepths);
+
+static void nestedScale(benchmark::State& state)
+{
+  const std::shared_ptr<grechin::CompositeShape> composite = makeNested(state.range(0));
+  double coefficient = 2;
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    composite->scale(coefficient);
+    coefficient = 1 / coefficient;
+    benchmark::DoNotOptimize(composite->getFrameRect());
+  }
+  setAllocationCounters(state, before);
+}
+BENCHMARK(nestedScale)->Apply(applyDepths);
+
+static void nestedRotate(benchmark::State& state)
+{
+  const std::shared_ptr<grechin::CompositeShape> composite = makeNested(state.range(0));
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    composite->rotate(15);
+    benchmark::DoNotOptimize(composite->getFrameRect());
+  }
+  setAllocationCounters(state, before);
+}
+BENCHMARK(nestedRotate)->Apply(applyDepths);
+
+static void nestedForEachLeaf(benchmark::State& state)
+{
+  const std::shared_ptr<grechin::CompositeShape> composite = makeNested(state.range(0));
+  const allocation_t before = getAllocations();
+  for (auto _ : state)
+  {
+    double area = 0;
+    composite->forEachLeaf([&area](const grechin::Shape& shape, const size_t count)
+    {
+      area += count * shape.getArea();
+    });
+    benchmark::DoNotOptimize(area);
+  }
+  setAllocationCounters(state, before);
+  state.SetItemsProcessed(state.iterations() * composite->getLeafCount());
+}
+BENCHMARK(nestedForEachLeaf)->Apply(applyDepths);
+
+static void narrowPhasePairs(benchmark::State& state)
+{
+  const grechin::CompositeShape composite = makeDense(state.range(0));
+  const std::vector<grechin::collider_t> colliders = addition::getColliders(composite);
+  const std::vector<grechin::index_pair_t> candidates = addition::findOverlapping(composite);
+  std::vector<grechin::index_pair_t> pairs;
+  for (auto _ : state)
+  {
+    pairs.clear();
+    for (const grechin::index_pair_t& pair : candidates)
+    {
+      if (addition::isIntersected(colliders[pair.first], colliders[pair.second]))
+      {
+        pairs.push_back(pair);
+      }
+    }
+    benchmark::DoNotOptimize(pairs.data());
+  }
+  state.counters["candidates"] = candidates.size();
+  state.counters["pairs"] = pairs.size();
+  state.SetItemsProcessed(state.iterations() * candidates.size());
+}
+BENCHMARK(narrowPhasePairs)->Apply(applySizes);
+
+static void narrowPhaseBatch(benchmark::State& state)
+{
+  const grechin::CompositeShape composite = makeDense(state.range(0));
+  const std::vector<grechin::collider_t> colliders = addition::getColliders(composite);
+  const std::vector<grechin::index_pair_t> candidates = addition::findOverlapping(composite);
+  grechin::NarrowPhase narrow;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(narrow.update(colliders, candidates).data());
+  }
+  state.counters["candidates"] = candidates.size();
+  state.counters["pairs"] = narrow.getPairs().size();
+  state.SetItemsProcessed(state.iterations() * candidates.size());
+}
+BENCHMARK(narrowPhaseBatch)->Apply(applySizes);
+
+static void unionArea(benchmark::State& state)
+{
+  grechin::CompositeShape composite = makeDense(state.range(0));
+  grechin::execution_policy_t policy = composite.getExecutionPolicy();
+  policy.parallel = state.range(1) != 0;
+  policy.threshold = 0;
+  composite.setExecutionPolicy(policy);
+  grechin::union_area_t area = {};
+  for (auto _ : state)
+  {
+    area = composite.getUnionArea(grechin::UNION_AREA_TOLERANCE);
+    benchmark::DoNotOptimize(area);
+  }
+  state.counters["coverage"] = area.area / composite.getArea();
+  state.counters["error"] = area.error / area.area;
+  state.SetItemsProcessed(state.iterations() * composite.getSize());
+}
+BENCHMARK(unionArea)->Apply(applyPolicies)->Unit(benchmark::kMillisecond);
+
+static void rasterize(benchmark::State& state)
+{
+  const grechin::CompositeShape composite = makeDense(state.range(0));
+  grechin::execution_policy_t policy = composite.getExecutionPolicy();
+  policy.parallel = state.range(1) != 0;
+  policy.threshold = 0;
+  const grechin::rectangle_t viewport = composite.getFrameRect();
+  const size_t size = 1024;
+  grechin::bitmap_t bitmap = {};
+  for (auto _ : state)
+  {
+    bitmap = grechin::rasterize(composite, viewport, size, size, grechin::RASTER_SAMPLES, policy);
+    benchmark::DoNotOptimize(bitmap.pixels.data());
+  }
+  double coverage = 0;
+  for (const uint8_t pixel : bitmap.pixels)
+  {
+    coverage += pixel;
+  }
+  state.counters["coverage"] = coverage / (255.0 * size * size);
+  state.SetItemsProcessed(state.iterations() * size * size);
+}
+BENCHMARK(rasterize)->Apply(applyPolicies)->Unit(benchmark::kMillisecond);
+
+static void concurrentRead(benchmark::State& state)
+{
+  const grechin::ConcurrentCompositeShape composite(makeDense(state.range(0)));
+  for (auto _ : state)
+  {
+    const grechin::ConcurrentCompositeShape::Snapshot snapshot = composite.getSnapshot();
+    benchmark::DoNotOptimize(snapshot->getFrameRect());
+    benchmark::DoNotOptimize(snapshot->getArea());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(concurrentRead)->Apply(applySizes);
+
+static void concurrentPublish(benchmark::State& state)
+{
+  grechin::ConcurrentCompositeShape composite(makeDense(state.range(0)));
+  const std::shared_ptr<grechin::Shape> circle = std::make_shared<grechin::Circle>(1, grechin::point_t{ 0, 0 });
+  for (auto _ : state)
+  {
+    composite.add(circle);
+    composite.remove(composite.getSize() - 1);
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(concurrentPublish)->Apply(applySizes);
+
+namespace
+{
+  const size_t INGEST_SHAPES = 1 << 20;
+
+  std::vector<std::vector<std::shared_ptr<grechin::Shape>>> makeBatches(const size_t producers)
+  {
+    std::vector<std::vector<std::shared_ptr<grechin::Shape>>> batches(producers);
+    for (size_t i = 0; i < INGEST_SHAPES; i++)
+    {
+      const grechin::point_t center = { static_cast<double>(i % 1000), static_cast<double>(i / 1000) };
+      batches[i * producers / INGEST_SHAPES].push_back(std::make_shared<grechin::Circle>(0.5, center));
+    }
+    return batches;
+  }
+
+  void applyProducers(benchmark::internal::Benchmark* benchmark)
+  {
+    for (const long producers : { 1, 4, 16 })
+    {
+      benchmark->Arg(producers);
+    }
+  }
+}
+
+static void ingestMutex(benchmark::State& state)
+{
+  const std::vector<std::vector<std::shared_ptr<grechin::Shape>>> batches = makeBatches(state.range(0));
+  for (auto _ : state)
+  {
+    grechin::CompositeShape composite;
+    std::mutex mutex;
+    std::vector<std::thread> threads;
+    for (const std::vector<std::shared_ptr<grechin::Shape>>& batch : batches)
+    {
+      threads.emplace_back([&composite, &mutex, &batch]()
+      {
+        for (const std::shared_ptr<grechin::Shape>& shape : batch)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          composite.add(shape);
+        }
+      });
+    }
+    for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+    benchmark::DoNotOptimize(composite.getSize());
+  }
+  state.SetItemsProcessed(state.iterations() * INGEST_SHAPES);
+}
+BENCHMARK(ingestMutex)->Apply(applyProducers)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void ingestBuffer(benchmark::State& state)
+{
+  const std::vector<std::vector<std::shared_ptr<grechin::Shape>>> batches = makeBatches(state.range(0));
+  for (auto _ : state)
+  {
+    grechin::CompositeShape composite;
+    grechin::IngestBuffer buffer;
+    std::vector<std::thread> threads;
+    for (const std::vector<std::shared_ptr<grechin::Shape>>& batch : batches)
+    {
+      threads.emplace_back([&buffer, &batch]()
+      {
+        grechin::IngestBuffer::Producer producer(buffer);
+        for (const std::shared_ptr<grechin::Shape>& shape : batch)
+        {
+          producer.push(shape);
+        }
+      });
+    }
+    for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+    buffer.commit(composite);
+    benchmark::DoNotOptimize(composite.getSize());
+  }
+  state.SetItemsProcessed(state.iterations() * INGEST_SHAPES);
+}
+BENCHMARK(ingestBuffer)->Apply(applyProducers)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
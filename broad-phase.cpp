@@ -0,0 +1,109 @@
+#include "broad-phase.hpp"
+
+#include <algorithm>
+#include "composite-shape.hpp"
+
+grechin::SweepAndPrune::SweepAndPrune()
+{}
+
+const std::vector<grechin::index_pair_t>& grechin::SweepAndPrune::update(const std::vector<rectangle_t>& frames)
+{
+  const size_t count = frames.size();
+  xMin_.resize(count);
+  xMax_.resize(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    xMin_[i] = frames[i].pos.x - frames[i].width / 2;
+    xMax_[i] = frames[i].pos.x + frames[i].width / 2;
+  }
+
+  if (order_.size() != count)
+  {
+    order_.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+      order_[i] = i;
+    }
+    std::sort(order_.begin(), order_.end(), [this](const size_t lhs, const size_t rhs)
+    {
+      return xMin_[lhs] < xMin_[rhs];
+    });
+  }
+  else
+  {
+    for (size_t i = 1; i < count; i++)
+    {
+      const size_t current = order_[i];
+      size_t j = i;
+      while (j > 0 && xMin_[order_[j - 1]] > xMin_[current])
+      {
+        order_[j] = order_[j - 1];
+        j--;
+      }
+      order_[j] = current;
+    }
+  }
+
+  pairs_.clear();
+  active_.clear();
+  for (const size_t current : order_)
+  {
+    size_t kept = 0;
+    for (const size_t other : active_)
+    {
+      if (xMax_[other] >= xMin_[current])
+      {
+        active_[kept++] = other;
+        if (addition::isOverlapped(frames[other], frames[current]))
+        {
+          pairs_.emplace_back(std::min(other, current), std::max(other, current));
+        }
+      }
+    }
+    active_.resize(kept);
+    active_.push_back(current);
+  }
+  std::sort(pairs_.begin(), pairs_.end());
+  return pairs_;
+}
+
+const std::vector<grechin::index_pair_t>& grechin::SweepAndPrune::update(const CompositeShape& shape)
+{
+  return update(addition::getFrames(shape));
+}
+
+const std::vector<grechin::index_pair_t>& grechin::SweepAndPrune::getPairs() const
+{
+  return pairs_;
+}
+
+void grechin::SweepAndPrune::reset()
+{
+  order_.clear();
+  xMin_.clear();
+  xMax_.clear();
+  active_.clear();
+  pairs_.clear();
+}
+
+std::vector<grechin::index_pair_t> addition::findOverlapping(const std::vector<grechin::rectangle_t>& frames)
+{
+  grechin::SweepAndPrune sweep;
+  return sweep.update(frames);
+}
+
+std::vector<grechin::index_pair_t> addition::findOverlapping(const grechin::CompositeShape& shape)
+{
+  return findOverlapping(getFrames(shape));
+}
+
+std::vector<grechin::rectangle_t> addition::getFrames(const grechin::CompositeShape& shape)
+{
+  std::vector<grechin::rectangle_t> frames;
+  frames.reserve(shape.getSize());
+  for (size_t i = 0; i < shape.getSize(); i++)
+  {
+    frames.push_back(shape[i]->getFrameRect());
+  }
+  return frames;
+}
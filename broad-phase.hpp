@@ -0,0 +1,41 @@
+#ifndef BROAD_PHASE_HPP
+#define BROAD_PHASE_HPP
+
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include "base-types.hpp"
+
+namespace grechin
+{
+  class CompositeShape;
+
+  typedef std::pair<size_t, size_t> index_pair_t;
+
+  class SweepAndPrune
+  {
+  public:
+    SweepAndPrune();
+
+    const std::vector<index_pair_t>& update(const std::vector<rectangle_t>&);
+    const std::vector<index_pair_t>& update(const CompositeShape&);
+    const std::vector<index_pair_t>& getPairs() const;
+    void reset();
+
+  private:
+    std::vector<size_t> order_;
+    std::vector<double> xMin_;
+    std::vector<double> xMax_;
+    std::vector<size_t> active_;
+    std::vector<index_pair_t> pairs_;
+  };
+}
+
+namespace addition
+{
+  std::vector<grechin::index_pair_t> findOverlapping(const std::vector<grechin::rectangle_t>&);
+  std::vector<grechin::index_pair_t> findOverlapping(const grechin::CompositeShape&);
+  std::vector<grechin::rectangle_t> getFrames(const grechin::CompositeShape&);
+}
+
+#endif
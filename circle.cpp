@@ -8,7 +8,8 @@
 
 grechin::Circle::Circle(const double radius, const point_t& center):
   radius_(radius),
-  center_(center)
+  center_(center),
+  revision_(0)
 {
   if (radius_ <= 0)
   {
@@ -16,43 +17,32 @@ grechin::Circle::Circle(const double radius, const point_t& center):
   }
 }
 
-double grechin::Circle::getArea() const
-{
-  return M_PI * radius_ * radius_;
-}
-
 double grechin::Circle::getRadius() const
 {
   return radius_;
 }
 
-grechin::rectangle_t grechin::Circle::getFrameRect() const
-{
-  return rectangle_t{ 2 * radius_, 2 * radius_, center_ };
-}
-
 void grechin::Circle::move(const point_t& movePoint)
 {
+  GRECHIN_INSTRUMENT_CALL(circleMove);
   center_ = movePoint;
-}
-
-void grechin::Circle::move(const double xMove, const double yMove)
-{
-  center_.x += xMove;
-  center_.y += yMove;
+  markEdited();
 }
 
 void grechin::Circle::scale(const double coefficient)
 {
+  GRECHIN_INSTRUMENT_CALL(circleScale);
   if (coefficient <= 0)
   {
     throw std::invalid_argument("Coefficient must be > 0");
   }
   radius_ *= coefficient;
+  markEdited();
 }
 
 void grechin::Circle::rotate(const double)
 {
+  GRECHIN_INSTRUMENT_CALL(circleRotate);
 }
 
 void grechin::Circle::setRadius(const double radius)
@@ -62,4 +52,5 @@ void grechin::Circle::setRadius(const double radius)
     throw std::invalid_argument("Radius must be > 0");
   }
   radius_ = radius;
+  markEdited();
 }
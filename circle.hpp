@@ -1,8 +1,10 @@
 #ifndef CIRCLE_HPP
 #define CIRCLE_HPP
 
+#include <cstdint>
 #include "shape.hpp"
 #include "base-types.hpp"
+#include "instrumentation.hpp"
 
 namespace grechin
 {
@@ -18,11 +20,48 @@ namespace grechin
     void scale(const double) override;
     void rotate(const double) override;
     void setRadius(const double);
+    uint64_t getRevision() const;
 
   private:
     double radius_;
     point_t center_;
+    uint64_t revision_;
+
+    void markEdited();
   };
 }
 
+inline double grechin::Circle::getArea() const
+{
+  GRECHIN_INSTRUMENT_CALL(circleGetArea);
+  // Spelled out so the header does not need _USE_MATH_DEFINES before <cmath>
+  constexpr double PI = 3.14159265358979323846;
+  return PI * radius_ * radius_;
+}
+
+inline grechin::rectangle_t grechin::Circle::getFrameRect() const
+{
+  GRECHIN_INSTRUMENT_CALL(circleGetFrameRect);
+  return rectangle_t{ 2 * radius_, 2 * radius_, center_ };
+}
+
+inline void grechin::Circle::move(const double xMove, const double yMove)
+{
+  GRECHIN_INSTRUMENT_CALL(circleMove);
+  center_.x += xMove;
+  center_.y += yMove;
+  markEdited();
+}
+
+inline uint64_t grechin::Circle::getRevision() const
+{
+  return revision_;
+}
+
+inline void grechin::Circle::markEdited()
+{
+  revision_++;
+  addition::markEdited();
+}
+
 #endif 
@@ -1,59 +1,238 @@
 #include "composite-shape.hpp"
 
+#include <cmath>
 #include <memory>
+#include <vector>
 #include <utility>
 #include <stdexcept>
 #include <algorithm>
+#include <typeinfo>
+#include <atomic>
+#include <unordered_map>
 #include "base-types.hpp"
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "instrumentation.hpp"
+
+namespace
+{
+  std::atomic<uint64_t> versionCounter(0);
+
+  std::atomic<uint64_t> editCounter(0);
+
+  uint64_t nextVersion()
+  {
+    return versionCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  uint64_t loadEdits()
+  {
+    // An edited circle or rectangle may sit in any subtree, so the global version moves with the edit count
+    if (addition::edited.load(std::memory_order_relaxed) && addition::edited.exchange(false, std::memory_order_relaxed))
+    {
+      nextVersion();
+      return editCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    return editCounter.load(std::memory_order_relaxed);
+  }
+
+  uint64_t getLeafRevision(const grechin::Shape& shape)
+  {
+    const std::type_info& type = typeid(shape);
+    if (type == typeid(grechin::Circle))
+    {
+      return static_cast<const grechin::Circle&>(shape).getRevision();
+    }
+    if (type == typeid(grechin::Rectangle))
+    {
+      return static_cast<const grechin::Rectangle&>(shape).getRevision();
+    }
+    return 0;
+  }
+
+  void addCompensated(double& sum, double& error, const double value)
+  {
+    const double result = sum + value;
+    if (std::fabs(sum) >= std::fabs(value))
+    {
+      error += (sum - result) + value;
+    }
+    else
+    {
+      error += (value - result) + sum;
+    }
+    sum = result;
+  }
+}
+
+template <typename Function>
+void grechin::CompositeShape::forEachChild(Function function) const
+{
+  GRECHIN_INSTRUMENT_CHILDREN(size_);
+  parallel::forEachChunk(size_, parallel::getThreadCount(policy_, size_),
+      [&](const size_t begin, const size_t end, const size_t)
+      {
+        for (size_t i = begin; i < end; i++)
+        {
+          if (array_[i] != nullptr)
+          {
+            function(*array_[i]);
+          }
+        }
+      });
+}
 
 grechin::CompositeShape::CompositeShape() :
   size_(0),
-  array_(nullptr)
+  capacity_(0),
+  array_(nullptr),
+  bounds_{ 0, 0, 0, 0 },
+  boundsValid_(false),
+  area_(0),
+  areaError_(0),
+  compensated_(true),
+  policy_(parallel::getDefaultPolicy()),
+  indexValid_(false),
+  arena_(nullptr),
+  transform_(getIdentity()),
+  transformed_(false),
+  compositeCount_(0),
+  customCount_(0),
+  dead_(0),
+  shared_(false),
+  version_(nextVersion()),
+  revision_(version_),
+  observed_(false),
+  deepRevision_(0),
+  deepVersion_(0),
+  stale_(false),
+  synced_(0),
+  checked_(0),
+  leafRevision_(0),
+  leafEdits_(0),
+  aliased_(false)
 {}
 
 grechin::CompositeShape::CompositeShape(const CompositeShape& shape) : 
   size_(shape.size_),
-  array_(nullptr)
+  capacity_(shape.capacity_),
+  array_(shape.array_),
+  bounds_(shape.bounds_),
+  boundsValid_(shape.boundsValid_),
+  area_(shape.area_),
+  areaError_(shape.areaError_),
+  compensated_(shape.compensated_),
+  policy_(shape.policy_),
+  indexValid_(false),
+  arena_(nullptr),
+  transform_(shape.transform_),
+  transformed_(shape.transformed_),
+  compositeCount_(shape.compositeCount_),
+  customCount_(shape.customCount_),
+  dead_(shape.dead_),
+  shared_(shape.size_ != 0),
+  version_(nextVersion()),
+  revision_(version_),
+  observed_(false),
+  deepRevision_(0),
+  deepVersion_(0),
+  nested_(shape.nested_),
+  stale_(shape.stale_),
+  synced_(0),
+  checked_(0),
+  leafRevision_(shape.leafRevision_),
+  leafEdits_(0),
+  aliased_(false)
 {
-  if (size_ != 0)
+  if (shared_ && !shape.shared_)
   {
-    array_ = ShapeArray(new std::shared_ptr<Shape>[size_]);
-    for (size_t i = 0; i < size_; i++)
-    {
-      array_[i] = shape.array_[i];
-    }
+    shape.shared_ = true;
   }
 }
 
 grechin::CompositeShape::CompositeShape(CompositeShape&& shape) noexcept :
   size_(shape.size_), 
-  array_(std::move(shape.array_))
+  capacity_(shape.capacity_),
+  array_(std::move(shape.array_)),
+  bounds_(shape.bounds_),
+  boundsValid_(shape.boundsValid_),
+  area_(shape.area_),
+  areaError_(shape.areaError_),
+  compensated_(shape.compensated_),
+  policy_(shape.policy_),
+  index_(std::move(shape.index_)),
+  indexValid_(shape.indexValid_.load()),
+  arena_(std::move(shape.arena_)),
+  transform_(shape.transform_),
+  transformed_(shape.transformed_),
+  compositeCount_(shape.compositeCount_),
+  customCount_(shape.customCount_),
+  dead_(shape.dead_),
+  shared_(shape.shared_),
+  version_(nextVersion()),
+  revision_(version_),
+  observed_(false),
+  deepRevision_(0),
+  deepVersion_(0),
+  nested_(std::move(shape.nested_)),
+  stale_(shape.stale_),
+  synced_(0),
+  checked_(0),
+  leafRevision_(shape.leafRevision_),
+  leafEdits_(0),
+  aliased_(false)
 {
-  if (size_ != 0)
-  {
-    shape.size_ = 0;
-  }
+  shape.size_ = 0;
+  shape.capacity_ = 0;
+  shape.boundsValid_ = false;
+  shape.area_ = 0;
+  shape.areaError_ = 0;
+  shape.index_.clear();
+  shape.indexValid_ = false;
+  shape.transform_ = getIdentity();
+  shape.transformed_ = false;
+  shape.compositeCount_ = 0;
+  shape.customCount_ = 0;
+  shape.dead_ = 0;
+  shape.shared_ = false;
+  shape.nested_.clear();
+  shape.stale_ = false;
+  shape.leafRevision_ = 0;
+  shape.touch();
 }
 
 grechin::CompositeShape& grechin::CompositeShape::operator=(const CompositeShape& shape)
 {
   if (this != &shape)
   {
-    if (shape.size_ != 0)
-    {
-      ShapeArray temp(new std::shared_ptr<Shape>[shape.size_]);
-      for (size_t i = 0; i < shape.size_; i++)
-      {
-        temp[i] = shape.array_[i];
-      }
-      size_ = shape.size_;
-      array_ = std::move(temp);
-    }
-    else
+    size_ = shape.size_;
+    capacity_ = shape.capacity_;
+    array_ = shape.array_;
+    bounds_ = shape.bounds_;
+    boundsValid_ = shape.boundsValid_;
+    area_ = shape.area_;
+    areaError_ = shape.areaError_;
+    compensated_ = shape.compensated_;
+    policy_ = shape.policy_;
+    index_.clear();
+    indexValid_ = false;
+    transform_ = shape.transform_;
+    transformed_ = shape.transformed_;
+    compositeCount_ = shape.compositeCount_;
+    customCount_ = shape.customCount_;
+    dead_ = shape.dead_;
+    shared_ = size_ != 0;
+    if (shared_ && !shape.shared_)
     {
-      size_ = 0;
-      array_ = nullptr;
+      shape.shared_ = true;
     }
+    nested_ = shape.nested_;
+    stale_ = shape.stale_;
+    synced_ = 0;
+    checked_ = 0;
+    leafRevision_ = shape.leafRevision_;
+    leafEdits_ = 0;
+    touch();
   }
   return *this;
 }
@@ -62,108 +241,421 @@ grechin::CompositeShape& grechin::CompositeShape::operator=(CompositeShape&& sha
 {
   if (this != &shape)
   {
-    if (shape.size_ != 0)
-    {
-      size_ = shape.size_;
-      shape.size_ = 0;
-      array_ = std::move(shape.array_);
-    }
-    else
-    {
-      size_ = 0;
-      array_ = nullptr;
-    }
+    size_ = shape.size_;
+    capacity_ = shape.capacity_;
+    array_ = std::move(shape.array_);
+    bounds_ = shape.bounds_;
+    boundsValid_ = shape.boundsValid_;
+    area_ = shape.area_;
+    areaError_ = shape.areaError_;
+    compensated_ = shape.compensated_;
+    policy_ = shape.policy_;
+    index_ = std::move(shape.index_);
+    indexValid_ = shape.indexValid_.load();
+    arena_ = std::move(shape.arena_);
+    transform_ = shape.transform_;
+    transformed_ = shape.transformed_;
+    compositeCount_ = shape.compositeCount_;
+    customCount_ = shape.customCount_;
+    dead_ = shape.dead_;
+    shared_ = shape.shared_;
+    nested_ = std::move(shape.nested_);
+    stale_ = shape.stale_;
+    synced_ = 0;
+    checked_ = 0;
+    leafRevision_ = shape.leafRevision_;
+    leafEdits_ = 0;
+    shape.size_ = 0;
+    shape.capacity_ = 0;
+    shape.boundsValid_ = false;
+    shape.area_ = 0;
+    shape.areaError_ = 0;
+    shape.index_.clear();
+    shape.indexValid_ = false;
+    shape.transform_ = getIdentity();
+    shape.transformed_ = false;
+    shape.compositeCount_ = 0;
+    shape.customCount_ = 0;
+    shape.dead_ = 0;
+    shape.shared_ = false;
+    shape.nested_.clear();
+    shape.stale_ = false;
+    touch();
+    shape.touch();
   }
   return *this;
 }
 
 std::shared_ptr<grechin::Shape> grechin::CompositeShape::operator[](const size_t number) const
 {
-  if (number >= size_)
+  if (number >= getSize())
   {
     throw std::out_of_range("Out of range");
   }
+  flush();
   return array_[number];
 }
 
 double grechin::CompositeShape::getArea() const
 {
-  double area = 0;
-  for (size_t i = 0; i < size_; i++)
-  {
-    area += array_[i]->getArea();
-  }
-  return area;
+  GRECHIN_INSTRUMENT_CALL(compositeGetArea);
+  syncNested();
+  return area_ + areaError_;
 }
 
 size_t grechin::CompositeShape::getSize() const
 {
-  return size_;
+  return size_ - dead_;
+}
+
+size_t grechin::CompositeShape::getCapacity() const
+{
+  return capacity_;
+}
+
+bool grechin::CompositeShape::isCompensated() const
+{
+  return compensated_;
+}
+
+void grechin::CompositeShape::setCompensated(const bool compensated)
+{
+  area_ += areaError_;
+  areaError_ = 0;
+  compensated_ = compensated;
+}
+
+grechin::execution_policy_t grechin::CompositeShape::getExecutionPolicy() const
+{
+  return policy_;
+}
+
+void grechin::CompositeShape::setExecutionPolicy(const execution_policy_t& policy)
+{
+  policy_ = policy;
+}
+
+grechin::ArenaPointer grechin::CompositeShape::getArena() const
+{
+  return arena_;
+}
+
+void grechin::CompositeShape::setArena(const ArenaPointer& arena)
+{
+  arena_ = arena;
 }
 
 grechin::rectangle_t grechin::CompositeShape::getFrameRect() const
 {
-  if (size_ == 0)
+  GRECHIN_INSTRUMENT_CALL(compositeGetFrameRect);
+  if (getSize() == 0)
   {
     return { 0, 0, {0, 0} };
   }
 
-  rectangle_t frame = array_[0]->getFrameRect();
-  double xMax = frame.pos.x + frame.width / 2;
-  double yMax = frame.pos.y + frame.height / 2;
-  double xMin = frame.pos.x - frame.width / 2;
-  double yMin = frame.pos.y - frame.height / 2;
-
-  for (size_t i = 1; i < size_; i++)
+  syncNested();
+  if (!boundsValid_)
   {
-    frame = array_[i]->getFrameRect();
-    xMax = std::max(xMax, frame.pos.x + frame.width / 2);
-    yMax = std::max(yMax, frame.pos.y + frame.height / 2);
-    xMin = std::min(xMin, frame.pos.x - frame.width / 2);
-    yMin = std::min(yMin, frame.pos.y - frame.height / 2);
+    flush();
+    computeBounds();
   }
+  const double xMax = bounds_.xMax;
+  const double yMax = bounds_.yMax;
+  const double xMin = bounds_.xMin;
+  const double yMin = bounds_.yMin;
   return rectangle_t{ xMax - xMin, yMax - yMin, { (xMax + xMin) / 2, (yMax + yMin) / 2 } };
 }
 
 void grechin::CompositeShape::add(const std::shared_ptr<Shape>& shape)
 {
-  if (shape == nullptr)
+  add(std::shared_ptr<Shape>(shape));
+}
+
+void grechin::CompositeShape::add(std::shared_ptr<Shape>&& shape)
+{
+  GRECHIN_INSTRUMENT_CALL(compositeAdd);
+  checkShape(shape);
+  // Only a child nobody else can see may be stored in the untransformed frame
+  const std::type_info& type = typeid(*shape);
+  const bool deferred = transformed_ && shape.use_count() == 1 && (type == typeid(Circle) || type == typeid(Rectangle));
+  if (!deferred)
   {
-    throw std::invalid_argument("Shape must not be nullptr");
+    applyTransform();
   }
-  if (shape.get() == this)
+  if (size_ == capacity_)
   {
-    throw std::invalid_argument("Shape must not be self adding");
+    grow();
   }
-
-  ShapeArray temp(new std::shared_ptr<Shape>[size_ + 1]);
-  for (size_t i = 0; i < size_; i++)
+  else
+  {
+    unshare();
+  }
+  const bool extend = boundsValid_ || getSize() == 0;
+  if (extend || indexValid_)
+  {
+    const rectangle_t frame = shape->getFrameRect();
+    if (extend)
+    {
+      extendBounds(frame);
+    }
+    if (indexValid_)
+    {
+      index_.insert(size_, frame);
+    }
+  }
+  addArea(shape->getArea());
+  countShape(*shape, true);
+  if (deferred)
   {
-    temp[i] = array_[i];
+    untransformShape(*shape, transform_);
   }
-  temp[size_] = shape;
+  leafRevision_ += getLeafRevision(*shape);
+  array_[size_] = std::move(shape);
   size_++;
-  array_ = std::move(temp);
+  touch();
+}
+
+std::shared_ptr<grechin::Circle> grechin::CompositeShape::emplaceCircle(const double radius, const point_t& center)
+{
+  if (arena_ == nullptr)
+  {
+    arena_ = makeArena();
+  }
+  std::shared_ptr<Circle> circle = std::allocate_shared<Circle>(ArenaAllocator<Circle>(arena_), radius, center);
+  add(circle);
+  return circle;
+}
+
+std::shared_ptr<grechin::Rectangle> grechin::CompositeShape::emplaceRectangle(const double width, const double height,
+    const point_t& center, const double angle)
+{
+  if (arena_ == nullptr)
+  {
+    arena_ = makeArena();
+  }
+  std::shared_ptr<Rectangle> rectangle = std::allocate_shared<Rectangle>(ArenaAllocator<Rectangle>(arena_), width,
+      height, center, angle);
+  add(rectangle);
+  return rectangle;
 }
 
 void grechin::CompositeShape::remove(const size_t number)
 {
-  if (number >= size_)
+  GRECHIN_INSTRUMENT_CALL(compositeRemove);
+  if (number >= getSize())
   {
     throw std::out_of_range("Out of range");
   }
 
+  compact();
+  unshare();
+  if (compositeCount_ != 0)
+  {
+    applyTransform();
+  }
+  detach(number);
   for (size_t i = number; i < size_ - 1; i++)
   {
-    array_[i] = array_[i + 1];
+    array_[i] = std::move(array_[i + 1]);
+  }
+  size_--;
+  array_[size_].reset();
+  indexValid_ = false;
+  touch();
+  resetIfEmpty();
+}
+
+void grechin::CompositeShape::swapRemove(const size_t number)
+{
+  GRECHIN_INSTRUMENT_CALL(compositeRemove);
+  if (number >= getSize())
+  {
+    throw std::out_of_range("Out of range");
+  }
+
+  compact();
+  unshare();
+  if (compositeCount_ != 0)
+  {
+    applyTransform();
   }
+  detach(number);
   size_--;
+  if (number != size_)
+  {
+    array_[number] = std::move(array_[size_]);
+  }
   array_[size_].reset();
+  indexValid_ = false;
+  touch();
+  resetIfEmpty();
+}
+
+size_t grechin::CompositeShape::removeIndices(const std::vector<size_t>& numbers)
+{
+  GRECHIN_INSTRUMENT_CALL(compositeRemove);
+  for (const size_t number : numbers)
+  {
+    if (number >= getSize())
+    {
+      throw std::out_of_range("Out of range");
+    }
+  }
+
+  compact();
+  unshare();
+  if (compositeCount_ != 0)
+  {
+    applyTransform();
+  }
+  std::vector<bool> removed(size_, false);
+  for (const size_t number : numbers)
+  {
+    removed[number] = true;
+  }
+  const size_t size = size_;
+  compactIf([this, &removed](const size_t number)
+  {
+    if (removed[number])
+    {
+      detach(number);
+      return true;
+    }
+    return false;
+  });
+  if (size_ != size)
+  {
+    indexValid_ = false;
+    touch();
+  }
+  resetIfEmpty();
+  return size - size_;
+}
+
+void grechin::CompositeShape::markRemoved(const size_t number)
+{
+  GRECHIN_INSTRUMENT_CALL(compositeRemove);
+  if (number >= size_)
+  {
+    throw std::out_of_range("Out of range");
+  }
+  if (array_[number] == nullptr)
+  {
+    throw std::logic_error("Shape is already removed");
+  }
+
+  unshare();
+  if (compositeCount_ != 0)
+  {
+    applyTransform();
+  }
+  detach(number);
+  array_[number].reset();
+  dead_++;
+  indexValid_ = false;
+  touch();
+  resetIfEmpty();
+}
+
+void grechin::CompositeShape::compact() const
+{
+  if (dead_ == 0)
+  {
+    return;
+  }
+
+  unshare();
+  compactIf([this](const size_t number)
+  {
+    return array_[number] == nullptr;
+  });
+  dead_ = 0;
+  indexValid_ = false;
+}
+
+void grechin::CompositeShape::reserve(const size_t capacity)
+{
+  if (capacity > capacity_)
+  {
+    reallocate(capacity);
+  }
+}
+
+void grechin::CompositeShape::shrink_to_fit()
+{
+  compact();
+  if (size_ < capacity_)
+  {
+    reallocate(size_);
+  }
+}
+
+void grechin::CompositeShape::refresh()
+{
+  flush();
+  recordLeaves();
+  boundsValid_ = false;
+  indexValid_ = false;
+  computeArea();
+  recordNested();
+  markChanged();
+}
+
+void grechin::CompositeShape::computeArea() const
+{
+  // Nested composites refresh their own caches before the children are read from several threads
+  for (const child_t& child : nested_)
+  {
+    child.shape->getArea();
+  }
+  area_ = 0;
+  areaError_ = 0;
+
+  const size_t chunks = parallel::getThreadCount(policy_, size_);
+  if (chunks == 1)
+  {
+    for (size_t i = 0; i < size_; i++)
+    {
+      addArea(array_[i]->getArea());
+    }
+  }
+  else if (policy_.deterministic)
+  {
+    std::vector<double> areas(size_);
+    parallel::forEachChunk(size_, chunks, [&](const size_t begin, const size_t end, const size_t)
+    {
+      for (size_t i = begin; i < end; i++)
+      {
+        areas[i] = array_[i]->getArea();
+      }
+    });
+    for (size_t i = 0; i < size_; i++)
+    {
+      addArea(areas[i]);
+    }
+  }
+  else
+  {
+    std::vector<double> sums(chunks, 0);
+    std::vector<double> errors(chunks, 0);
+    parallel::forEachChunk(size_, chunks, [&](const size_t begin, const size_t end, const size_t chunk)
+    {
+      for (size_t i = begin; i < end; i++)
+      {
+        addCompensated(sums[chunk], errors[chunk], array_[i]->getArea());
+      }
+    });
+    for (size_t i = 0; i < chunks; i++)
+    {
+      addArea(sums[i]);
+      addArea(errors[i]);
+    }
+  }
 }
 
 void grechin::CompositeShape::move(const point_t& movePoint)
 {
-  if (size_ == 0)
+  if (getSize() == 0)
   {
     throw std::logic_error("CompositeShape is empty");
   }
@@ -174,51 +666,1035 @@ void grechin::CompositeShape::move(const point_t& movePoint)
 
 void grechin::CompositeShape::move(const double xMove, const double yMove)
 {
-  if (size_ == 0)
-  {
-    throw std::logic_error("CompositeShape is empty");
-  }
+  GRECHIN_INSTRUMENT_CALL(compositeMove);
+  checkEmpty();
 
-  for (size_t i = 0; i < size_; i++)
+  transform_.offset.x += xMove;
+  transform_.offset.y += yMove;
+  transformed_ = true;
+  markChanged();
+  if (boundsValid_)
   {
-    array_[i]->move(xMove, yMove);
+    bounds_.xMin += xMove;
+    bounds_.xMax += xMove;
+    bounds_.yMin += yMove;
+    bounds_.yMax += yMove;
   }
+  index_.translate(xMove, yMove);
 }
 
 void grechin::CompositeShape::scale(const double coefficient)
 {
+  GRECHIN_INSTRUMENT_CALL(compositeScale);
   if (coefficient <= 0)
   {
     throw std::invalid_argument("Coefficient must be > 0");
   }
-  if (size_ == 0)
+  checkEmpty();
+
+  const point_t center = getFrameRect().pos;
+  markChanged();
+  if (customCount_ != 0)
   {
-    throw std::logic_error("CompositeShape is empty");
+    flush();
+    cloneChildren();
+    forEachChild([&center, coefficient](Shape& shape)
+    {
+      shape.scale(coefficient);
+      const point_t shapeCenter = shape.getFrameRect().pos;
+      const double xMove = (shapeCenter.x - center.x) * (coefficient - 1);
+      const double yMove = (shapeCenter.y - center.y) * (coefficient - 1);
+      shape.move(xMove, yMove);
+    });
+    recordLeaves();
+    boundsValid_ = false;
+  }
+  else
+  {
+    transform_.xx *= coefficient;
+    transform_.xy *= coefficient;
+    transform_.yx *= coefficient;
+    transform_.yy *= coefficient;
+    transform_.offset.x += (transform_.offset.x - center.x) * (coefficient - 1);
+    transform_.offset.y += (transform_.offset.y - center.y) * (coefficient - 1);
+    transform_.scale *= coefficient;
+    transformed_ = true;
+    bounds_.xMin += (bounds_.xMin - center.x) * (coefficient - 1);
+    bounds_.xMax += (bounds_.xMax - center.x) * (coefficient - 1);
+    bounds_.yMin += (bounds_.yMin - center.y) * (coefficient - 1);
+    bounds_.yMax += (bounds_.yMax - center.y) * (coefficient - 1);
   }
+  indexValid_ = false;
+  area_ *= coefficient * coefficient;
+  areaError_ *= coefficient * coefficient;
+}
+
+void grechin::CompositeShape::rotate(const double angle)
+{
+  GRECHIN_INSTRUMENT_CALL(compositeRotate);
+  checkEmpty();
 
   const point_t center = getFrameRect().pos;
+  const rotation_t rotation = addition::getRotation(angle);
+  markChanged();
+  if (compositeCount_ + customCount_ != 0)
+  {
+    flush();
+    cloneChildren();
+    if (compositeCount_ != 0)
+    {
+      flushNodes(true);
+      rotateTree(angle, center);
+    }
+    else
+    {
+      forEachChild([&center, &rotation, angle](Shape& shape)
+      {
+        shape.rotate(angle);
+        point_t shapeCenter = shape.getFrameRect().pos;
+        addition::revolve(shapeCenter, center, rotation);
+        shape.move(shapeCenter);
+      });
+      recordLeaves();
+      boundsValid_ = false;
+    }
+    indexValid_ = false;
+    return;
+  }
+
+  point_t xAxis = { center.x + transform_.xx, center.y + transform_.yx };
+  point_t yAxis = { center.x + transform_.xy, center.y + transform_.yy };
+  addition::revolve(xAxis, center, rotation);
+  addition::revolve(yAxis, center, rotation);
+  addition::revolve(transform_.offset, center, rotation);
+  transform_.xx = xAxis.x - center.x;
+  transform_.yx = xAxis.y - center.y;
+  transform_.xy = yAxis.x - center.x;
+  transform_.yy = yAxis.y - center.y;
+  transform_.angle += angle;
+  transformed_ = true;
+  boundsValid_ = false;
+  indexValid_ = false;
+}
+
+void grechin::CompositeShape::flush() const
+{
+  GRECHIN_INSTRUMENT_CALL(compositeFlush);
+  compact();
+  applyTransform();
+}
+
+void grechin::CompositeShape::prepare() const
+{
+  flush();
   for (size_t i = 0; i < size_; i++)
   {
-    array_[i]->scale(coefficient);
-    const double xMove = (array_[i]->getFrameRect().pos.x - center.x) * (coefficient - 1);
-    const double yMove = (array_[i]->getFrameRect().pos.y - center.y) * (coefficient - 1);
-    array_[i]->move(xMove, yMove);
+    if (typeid(*array_[i]) == typeid(CompositeShape))
+    {
+      static_cast<const CompositeShape&>(*array_[i]).prepare();
+    }
   }
+  flushNodes(false);
+  getFrameRect();
 }
 
-void grechin::CompositeShape::rotate(const double angle)
+std::vector<size_t> grechin::CompositeShape::queryOverlapping(const rectangle_t& area) const
+{
+  return getIndex().queryOverlapping(area);
+}
+
+std::vector<size_t> grechin::CompositeShape::queryPoint(const point_t& point) const
+{
+  return getIndex().queryPoint(point);
+}
+
+std::vector<size_t> grechin::CompositeShape::nearest(const point_t& point, const size_t count) const
+{
+  return getIndex().nearest(point, count);
+}
+
+void grechin::CompositeShape::checkEmpty() const
 {
-  if (size_ == 0)
+  // Transforms are deferred, so an empty nested composite is reported here as the eager walk did. The
+  // result holds while only this composite changes; adding a composite or any edit below resets it.
+  if (getSize() == 0)
   {
     throw std::logic_error("CompositeShape is empty");
   }
+  if (nested_.empty())
+  {
+    return;
+  }
+  const uint64_t version = versionCounter.load(std::memory_order_relaxed);
+  if (checked_.load(std::memory_order_relaxed) == version)
+  {
+    return;
+  }
+  for (const child_t& child : nested_)
+  {
+    child.shape->checkEmpty();
+  }
+  checked_.store(version, std::memory_order_relaxed);
+}
 
-  const point_t center = getFrameRect().pos;
-  for (size_t i = 0; i < size_; i++)
+void grechin::CompositeShape::checkShape(const std::shared_ptr<Shape>& shape) const
+{
+  if (shape == nullptr)
+  {
+    throw std::invalid_argument("Shape must not be nullptr");
+  }
+  if (shape.get() == this)
+  {
+    throw std::invalid_argument("Shape must not be self adding");
+  }
+}
+
+void grechin::CompositeShape::applyTransform() const
+{
+  if (!transformed_)
   {
-    array_[i]->rotate(angle);
-    point_t shapeCenter = array_[i]->getFrameRect().pos;
-    addition::revolve(shapeCenter, center, angle);
-    array_[i]->move(shapeCenter);
+    return;
+  }
+
+  cloneChildren();
+  if (compositeCount_ != 0)
+  {
+    flushNodes(true);
+  }
+  // Emptiness is checked when the transform is deferred, so only a throwing custom shape can fail the walk
+  const transform_t transform = transform_;
+  transform_ = getIdentity();
+  transformed_ = false;
+  try
+  {
+    if (compositeCount_ != 0)
+    {
+      transformTree(transform);
+      return;
+    }
+    syncLeaves();
+    forEachChild([&transform](Shape& shape)
+    {
+      transformShape(shape, transform);
+    });
+    recordLeaves();
+  }
+  catch (...)
+  {
+    transform_ = transform;
+    transformed_ = true;
+    throw;
+  }
+}
+
+void grechin::CompositeShape::detach(const size_t number)
+{
+  countShape(*array_[number], false);
+  if (transformed_ && shared_ && array_[number].use_count() > 1)
+  {
+    array_[number] = cloneShape(array_[number]);
+  }
+  Shape& shape = *array_[number];
+  leafRevision_ -= getLeafRevision(shape);
+  if (transformed_)
+  {
+    transformShape(shape, transform_);
+  }
+  // Deferred scales round the cached bounds differently from the child frames, so no edge test is exact
+  boundsValid_ = false;
+  if (typeid(shape) == typeid(CompositeShape))
+  {
+    // The subtree may have changed since its area was added, so the caches are summed again on the next read
+    stale_ = true;
+    return;
+  }
+  addArea(-shape.getArea());
+}
+
+void grechin::CompositeShape::resetIfEmpty()
+{
+  if (getSize() == 0)
+  {
+    area_ = 0;
+    areaError_ = 0;
+    boundsValid_ = false;
+    stale_ = false;
+  }
+}
+
+void grechin::CompositeShape::countShape(const Shape& shape, const bool added)
+{
+  const std::type_info& type = typeid(shape);
+  if (type == typeid(Circle) || type == typeid(Rectangle))
+  {
+    return;
+  }
+  size_t& count = (type == typeid(CompositeShape)) ? compositeCount_ : customCount_;
+  if (added)
+  {
+    count++;
+  }
+  else
+  {
+    count--;
+  }
+  if (type != typeid(CompositeShape))
+  {
+    return;
+  }
+
+  const CompositeShape* composite = static_cast<const CompositeShape*>(&shape);
+  if (added)
+  {
+    nested_.push_back({ composite, composite->getRevision() });
+    checked_.store(0, std::memory_order_relaxed);
+    return;
+  }
+  const auto child = std::find_if(nested_.begin(), nested_.end(), [composite](const child_t& child)
+  {
+    return child.shape == composite;
+  });
+  if (child != nested_.end())
+  {
+    *child = nested_.back();
+    nested_.pop_back();
+  }
+}
+
+grechin::CompositeShape::bounds_t grechin::CompositeShape::getBounds(const rectangle_t& frame)
+{
+  const double xMax = frame.pos.x + frame.width / 2;
+  const double yMax = frame.pos.y + frame.height / 2;
+  const double xMin = frame.pos.x - frame.width / 2;
+  const double yMin = frame.pos.y - frame.height / 2;
+  return bounds_t{ xMin, yMin, xMax, yMax };
+}
+
+void grechin::CompositeShape::transformShape(Shape& shape, const transform_t& transform)
+{
+  if (transform.scale != 1)
+  {
+    shape.scale(transform.scale);
+  }
+  if (transform.angle != 0)
+  {
+    shape.rotate(transform.angle);
+  }
+  if (transform.xx == 1 && transform.xy == 0 && transform.yx == 0 && transform.yy == 1)
+  {
+    if (transform.offset.x != 0 || transform.offset.y != 0)
+    {
+      shape.move(transform.offset.x, transform.offset.y);
+    }
+    return;
+  }
+  const point_t center = shape.getFrameRect().pos;
+  const double x = transform.xx * center.x + transform.xy * center.y + transform.offset.x;
+  const double y = transform.yx * center.x + transform.yy * center.y + transform.offset.y;
+  shape.move(x - center.x, y - center.y);
+}
+
+void grechin::CompositeShape::untransformShape(Shape& shape, const transform_t& transform)
+{
+  // Puts a leaf where the pending transform will carry it back, so adding under a deferred move stays O(1)
+  if (transform.scale != 1)
+  {
+    shape.scale(1 / transform.scale);
+  }
+  if (transform.angle != 0)
+  {
+    shape.rotate(-transform.angle);
+  }
+  const point_t center = shape.getFrameRect().pos;
+  const double dx = center.x - transform.offset.x;
+  const double dy = center.y - transform.offset.y;
+  const double determinant = transform.xx * transform.yy - transform.xy * transform.yx;
+  const double x = (transform.yy * dx - transform.xy * dy) / determinant;
+  const double y = (transform.xx * dy - transform.yx * dx) / determinant;
+  shape.move(x - center.x, y - center.y);
+}
+
+std::shared_ptr<grechin::Shape> grechin::CompositeShape::cloneShape(const std::shared_ptr<Shape>& shape)
+{
+  const std::type_info& type = typeid(*shape);
+  if (type == typeid(Circle))
+  {
+    return std::make_shared<Circle>(static_cast<const Circle&>(*shape));
+  }
+  if (type == typeid(Rectangle))
+  {
+    return std::make_shared<Rectangle>(static_cast<const Rectangle&>(*shape));
+  }
+  if (type == typeid(CompositeShape))
+  {
+    return std::make_shared<CompositeShape>(static_cast<const CompositeShape&>(*shape));
+  }
+  return shape;
+}
+
+grechin::CompositeShape::transform_t grechin::CompositeShape::getIdentity()
+{
+  return transform_t{ 1, 0, 0, 1, { 0, 0 }, 1, 0 };
+}
+
+void grechin::CompositeShape::unite(bounds_t& bounds, const bounds_t& other)
+{
+  bounds.xMax = std::max(bounds.xMax, other.xMax);
+  bounds.yMax = std::max(bounds.yMax, other.yMax);
+  bounds.xMin = std::min(bounds.xMin, other.xMin);
+  bounds.yMin = std::min(bounds.yMin, other.yMin);
+}
+
+void grechin::CompositeShape::extendBounds(const rectangle_t& frame) const
+{
+  if (boundsValid_)
+  {
+    unite(bounds_, getBounds(frame));
+  }
+  else
+  {
+    bounds_ = getBounds(frame);
+    boundsValid_ = true;
+  }
+}
+
+void grechin::CompositeShape::computeBounds() const
+{
+  GRECHIN_INSTRUMENT_CHILDREN(size_);
+  for (const child_t& child : nested_)
+  {
+    child.shape->getFrameRect();
+  }
+  const size_t chunks = parallel::getThreadCount(policy_, size_);
+  std::vector<bounds_t> partial(chunks);
+  parallel::forEachChunk(size_, chunks, [&](const size_t begin, const size_t end, const size_t chunk)
+  {
+    partial[chunk] = getBounds(array_[begin]->getFrameRect());
+    for (size_t i = begin + 1; i < end; i++)
+    {
+      unite(partial[chunk], getBounds(array_[i]->getFrameRect()));
+    }
+  });
+  bounds_ = partial[0];
+  for (size_t i = 1; i < chunks; i++)
+  {
+    unite(bounds_, partial[i]);
+  }
+  boundsValid_ = true;
+}
+
+const grechin::SpatialGrid& grechin::CompositeShape::getIndex() const
+{
+  syncNested();
+  if (indexValid_.load(std::memory_order_acquire))
+  {
+    return index_;
+  }
+
+  // A published snapshot builds its index on the first query, so concurrent readers wait only for each other
+  std::lock_guard<std::mutex> lock(indexMutex_);
+  if (!indexValid_.load(std::memory_order_relaxed))
+  {
+    flush();
+    GRECHIN_INSTRUMENT_CHILDREN(size_);
+    std::vector<rectangle_t> frames(size_);
+    parallel::forEachChunk(size_, parallel::getThreadCount(policy_, size_),
+        [&](const size_t begin, const size_t end, const size_t)
+        {
+          for (size_t i = begin; i < end; i++)
+          {
+            frames[i] = array_[i]->getFrameRect();
+          }
+        });
+    index_.build(frames);
+    indexValid_.store(true, std::memory_order_release);
+  }
+  return index_;
+}
+
+void grechin::CompositeShape::addArea(const double area) const
+{
+  if (compensated_)
+  {
+    addCompensated(area_, areaError_, area);
+  }
+  else
+  {
+    area_ += area;
+  }
+}
+
+void grechin::CompositeShape::reallocate(const size_t capacity)
+{
+  GRECHIN_INSTRUMENT_CALL(compositeReallocate);
+  GRECHIN_INSTRUMENT_ALLOCATION(capacity * sizeof(std::shared_ptr<Shape>));
+  ShapeArray temp(capacity != 0 ? new std::shared_ptr<Shape>[capacity] : nullptr);
+  const bool unique = array_.use_count() == 1;
+  for (size_t i = 0; i < size_; i++)
+  {
+    if (unique)
+    {
+      temp[i] = std::move(array_[i]);
+    }
+    else
+    {
+      temp[i] = array_[i];
+    }
+  }
+  capacity_ = capacity;
+  array_ = std::move(temp);
+}
+
+void grechin::CompositeShape::unshare() const
+{
+  if (array_.use_count() > 1)
+  {
+    GRECHIN_INSTRUMENT_ALLOCATION(capacity_ * sizeof(std::shared_ptr<Shape>));
+    ShapeArray temp(new std::shared_ptr<Shape>[capacity_]);
+    for (size_t i = 0; i < size_; i++)
+    {
+      temp[i] = array_[i];
+    }
+    array_ = std::move(temp);
+  }
+}
+
+void grechin::CompositeShape::cloneChildren() const
+{
+  if (!shared_)
+  {
+    return;
+  }
+
+  stale_ = isNestedChanged();
+  unshare();
+  parallel::forEachChunk(size_, parallel::getThreadCount(policy_, size_),
+      [this](const size_t begin, const size_t end, const size_t)
+      {
+        for (size_t i = begin; i < end; i++)
+        {
+          if (array_[i].use_count() > 1)
+          {
+            array_[i] = cloneShape(array_[i]);
+          }
+        }
+      });
+  if (compositeCount_ != 0)
+  {
+    nested_.clear();
+    for (size_t i = 0; i < size_; i++)
+    {
+      if (array_[i] != nullptr && typeid(*array_[i]) == typeid(CompositeShape))
+      {
+        const CompositeShape* composite = static_cast<const CompositeShape*>(array_[i].get());
+        nested_.push_back({ composite, composite->getRevision() });
+      }
+    }
+  }
+  shared_ = false;
+  // Clones keep the geometry, so only the traversal plan goes stale
+  version_ = nextRevision();
+}
+
+void grechin::CompositeShape::grow()
+{
+  reallocate(capacity_ == 0 ? 1 : capacity_ * 2);
+}
+
+void grechin::CompositeShape::touch() const
+{
+  version_ = nextRevision();
+  revision_ = version_;
+  observed_ = false;
+}
+
+void grechin::CompositeShape::markChanged() const
+{
+  // A revision no parent has read yet cannot be recorded anywhere, so it is reused until it is read
+  if (observed_)
+  {
+    revision_ = nextRevision();
+    observed_ = false;
+  }
+}
+
+uint64_t grechin::CompositeShape::nextRevision() const
+{
+  // Changes made by this composite itself are already in its caches and do not force a check of the subtree
+  const uint64_t revision = nextVersion();
+  if (synced_.load(std::memory_order_relaxed) == revision - 1)
+  {
+    synced_.store(revision, std::memory_order_relaxed);
+  }
+  if (checked_.load(std::memory_order_relaxed) == revision - 1)
+  {
+    checked_.store(revision, std::memory_order_relaxed);
+  }
+  return revision;
+}
+
+uint64_t grechin::CompositeShape::getRevision() const
+{
+  if (!observed_)
+  {
+    observed_ = true;
+  }
+  syncLeaves();
+  if (nested_.empty())
+  {
+    return revision_;
+  }
+  // The subtree cannot change without the global version moving, so one walk serves every parent
+  const uint64_t version = versionCounter.load(std::memory_order_relaxed);
+  if (deepVersion_.load(std::memory_order_acquire) == version)
+  {
+    return deepRevision_.load(std::memory_order_relaxed);
+  }
+  uint64_t revision = revision_;
+  for (const child_t& child : nested_)
+  {
+    revision = std::max(revision, child.shape->getRevision());
+  }
+  deepRevision_.store(revision, std::memory_order_relaxed);
+  deepVersion_.store(version, std::memory_order_release);
+  return revision;
+}
+
+bool grechin::CompositeShape::isNestedChanged() const
+{
+  if (stale_)
+  {
+    return true;
+  }
+  for (const child_t& child : nested_)
+  {
+    if (child.shape->getRevision() != child.revision)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void grechin::CompositeShape::syncNested() const
+{
+  // A nested composite may be edited through a handle after it was added, which the running area and
+  // the cached frame do not see. They are recomputed once the subtree revision moves. Every such edit
+  // advances the global version, so the subtree is not walked while that stays put.
+  syncLeaves();
+  if (nested_.empty() && !stale_)
+  {
+    return;
+  }
+  const uint64_t version = versionCounter.load(std::memory_order_relaxed);
+  if (!stale_ && synced_.load(std::memory_order_relaxed) == version)
+  {
+    return;
+  }
+  if (!isNestedChanged())
+  {
+    synced_.store(version, std::memory_order_relaxed);
+    return;
+  }
+
+  flush();
+  computeArea();
+  recordNested();
+  boundsValid_ = false;
+  indexValid_ = false;
+  synced_.store(versionCounter.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void grechin::CompositeShape::recordNested() const
+{
+  for (child_t& child : nested_)
+  {
+    child.revision = child.shape->getRevision();
+  }
+  stale_ = false;
+}
+
+uint64_t grechin::CompositeShape::sumLeaves() const
+{
+  uint64_t revision = 0;
+  for (size_t i = 0; i < size_; i++)
+  {
+    if (array_[i] != nullptr)
+    {
+      revision += getLeafRevision(*array_[i]);
+    }
+  }
+  return revision;
+}
+
+void grechin::CompositeShape::syncLeaves() const
+{
+  // Circles and rectangles edited through a handle bump their own revision and raise a global flag. Once
+  // the flag moved, the revisions of the children are summed again, and a new sum counts as an edit here.
+  const uint64_t edits = loadEdits();
+  if (leafEdits_.load(std::memory_order_relaxed) == edits)
+  {
+    return;
+  }
+  const uint64_t revision = sumLeaves();
+  if (revision != leafRevision_)
+  {
+    leafRevision_ = revision;
+    stale_ = true;
+    markChanged();
+  }
+  leafEdits_.store(edits, std::memory_order_relaxed);
+}
+
+void grechin::CompositeShape::recordLeaves() const
+{
+  // Edits this composite made itself are already in its caches
+  leafRevision_ = sumLeaves();
+  leafEdits_.store(loadEdits(), std::memory_order_relaxed);
+}
+
+size_t grechin::CompositeShape::getLeafCount() const
+{
+  if (!isPlanValid())
+  {
+    buildPlan();
+  }
+  return leaves_.size();
+}
+
+double grechin::CompositeShape::getUnionArea() const
+{
+  return getUnionArea(UNION_AREA_TOLERANCE).area;
+}
+
+grechin::union_area_t grechin::CompositeShape::getUnionArea(const double tolerance) const
+{
+  std::vector<collider_t> colliders;
+  forEachLeaf([&colliders](const Shape& shape, const size_t)
+  {
+    colliders.push_back(getCollider(shape));
+  });
+  return grechin::getUnionArea(colliders, tolerance, policy_);
+}
+
+bool grechin::CompositeShape::isPlanValid() const
+{
+  if (nodes_.empty() || nodes_.front().shape != this)
+  {
+    return false;
+  }
+  for (const node_t& node : nodes_)
+  {
+    if (node.shape->version_ != node.version)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void grechin::CompositeShape::buildPlan() const
+{
+  struct frame_t
+  {
+    CompositeShape* shape;
+    size_t next;
+  };
+
+  CompositeShape* root = const_cast<CompositeShape*>(this);
+  std::unordered_map<const CompositeShape*, bool> finished = { { root, false } };
+  std::vector<CompositeShape*> order;
+  std::vector<frame_t> stack = { { root, 0 } };
+  while (!stack.empty())
+  {
+    frame_t& frame = stack.back();
+    if (frame.next == frame.shape->size_)
+    {
+      finished[frame.shape] = true;
+      order.push_back(frame.shape);
+      stack.pop_back();
+      continue;
+    }
+    const std::shared_ptr<Shape>& child = frame.shape->array_[frame.next++];
+    if (child == nullptr || typeid(*child) != typeid(CompositeShape))
+    {
+      continue;
+    }
+    CompositeShape* composite = static_cast<CompositeShape*>(child.get());
+    const auto state = finished.try_emplace(composite, false);
+    if (state.second)
+    {
+      stack.push_back({ composite, 0 });
+    }
+    else if (!state.first->second)
+    {
+      throw std::logic_error("CompositeShape contains a cycle");
+    }
+  }
+  std::reverse(order.begin(), order.end());
+
+  std::unordered_map<const CompositeShape*, size_t> nodeIndex;
+  std::unordered_map<const Shape*, size_t> leafIndex;
+  std::vector<size_t> counts(order.size(), 0);
+  std::vector<node_t> nodes;
+  std::vector<leaf_t> leaves;
+  nodes.reserve(order.size());
+  for (size_t i = 0; i < order.size(); i++)
+  {
+    nodeIndex[order[i]] = i;
+    nodes.push_back({ order[i], order[i]->version_ });
+  }
+  counts[0] = 1;
+  for (size_t i = 0; i < order.size(); i++)
+  {
+    const CompositeShape& node = *order[i];
+    for (size_t j = 0; j < node.size_; j++)
+    {
+      Shape* child = node.array_[j].get();
+      if (child == nullptr)
+      {
+        continue;
+      }
+      if (typeid(*child) == typeid(CompositeShape))
+      {
+        counts[nodeIndex[static_cast<CompositeShape*>(child)]] += counts[i];
+        continue;
+      }
+      const auto index = leafIndex.try_emplace(child, leaves.size());
+      if (index.second)
+      {
+        leaves.push_back({ child, 0 });
+      }
+      leaves[index.first->second].count += counts[i];
+    }
+  }
+  aliased_ = std::any_of(counts.begin(), counts.end(), [](const size_t count)
+  {
+    return count > 1;
+  });
+  aliased_ = aliased_ || std::any_of(leaves.begin(), leaves.end(), [](const leaf_t& leaf)
+  {
+    return leaf.count > 1;
+  });
+  nodes_ = std::move(nodes);
+  leaves_ = std::move(leaves);
+}
+
+void grechin::CompositeShape::flushNodes(const bool exclusive) const
+{
+  bool valid = false;
+  while (!valid)
+  {
+    if (!isPlanValid())
+    {
+      buildPlan();
+    }
+    valid = true;
+    for (size_t i = 1; i < nodes_.size() && valid; i++)
+    {
+      const CompositeShape& node = *nodes_[i].shape;
+      node.flush();
+      if (exclusive)
+      {
+        node.cloneChildren();
+      }
+      valid = node.version_ == nodes_[i].version;
+    }
+  }
+}
+
+void grechin::CompositeShape::transformTree(const transform_t& transform) const
+{
+  for (const node_t& node : nodes_)
+  {
+    node.shape->syncLeaves();
+  }
+  GRECHIN_INSTRUMENT_CHILDREN(leaves_.size());
+  parallel::forEachChunk(leaves_.size(), parallel::getThreadCount(policy_, leaves_.size()),
+      [this, &transform](const size_t begin, const size_t end, const size_t)
+      {
+        for (size_t i = begin; i < end; i++)
+        {
+          transformShape(*leaves_[i].shape, transform);
+        }
+      });
+
+  const double factor = transform.scale * transform.scale;
+  for (size_t i = 1; i < nodes_.size(); i++)
+  {
+    CompositeShape& node = *nodes_[i].shape;
+    if (node.boundsValid_)
+    {
+      node.bounds_.xMin = transform.xx * node.bounds_.xMin + transform.offset.x;
+      node.bounds_.xMax = transform.xx * node.bounds_.xMax + transform.offset.x;
+      node.bounds_.yMin = transform.yy * node.bounds_.yMin + transform.offset.y;
+      node.bounds_.yMax = transform.yy * node.bounds_.yMax + transform.offset.y;
+    }
+    node.area_ *= factor;
+    node.areaError_ *= factor;
+    if (transform.scale == 1)
+    {
+      node.index_.translate(transform.offset.x, transform.offset.y);
+    }
+    else
+    {
+      node.indexValid_ = false;
+    }
+  }
+  reviseTree();
+}
+
+void grechin::CompositeShape::rotateTree(const double angle, const point_t& center) const
+{
+  const rotation_t rotation = addition::getRotation(angle);
+  for (const node_t& node : nodes_)
+  {
+    node.shape->syncLeaves();
+  }
+  if (aliased_)
+  {
+    GRECHIN_INSTRUMENT_CHILDREN(leaves_.size());
+    parallel::forEachChunk(leaves_.size(), parallel::getThreadCount(policy_, leaves_.size()),
+        [this, &center, &rotation, angle](const size_t begin, const size_t end, const size_t)
+        {
+          for (size_t i = begin; i < end; i++)
+          {
+            Shape& shape = *leaves_[i].shape;
+            shape.rotate(angle);
+            point_t shapeCenter = shape.getFrameRect().pos;
+            addition::revolve(shapeCenter, center, rotation);
+            shape.move(shapeCenter);
+          }
+        });
+    for (const node_t& node : nodes_)
+    {
+      node.shape->boundsValid_ = false;
+      node.shape->indexValid_ = false;
+    }
+    reviseTree();
+    return;
+  }
+
+  const size_t count = nodes_.size();
+  std::unordered_map<const Shape*, size_t> nodeIndex;
+  std::vector<point_t> centers(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    nodeIndex[nodes_[i].shape] = i;
+    centers[i] = nodes_[i].shape->getFrameRect().pos;
+  }
+
+  std::vector<bounds_t> frames(count);
+  std::vector<point_t> offsets(count, point_t{ 0, 0 });
+  for (size_t i = count; i-- > 0;)
+  {
+    const CompositeShape& node = *nodes_[i].shape;
+    GRECHIN_INSTRUMENT_CHILDREN(node.size_);
+    bool first = true;
+    for (size_t j = 0; j < node.size_; j++)
+    {
+      Shape* shape = node.array_[j].get();
+      if (shape == nullptr)
+      {
+        continue;
+      }
+      bounds_t bounds = {};
+      if (typeid(*shape) == typeid(CompositeShape))
+      {
+        const size_t child = nodeIndex[shape];
+        bounds = frames[child];
+        point_t shapeCenter = { (bounds.xMin + bounds.xMax) / 2, (bounds.yMin + bounds.yMax) / 2 };
+        const point_t previous = shapeCenter;
+        addition::revolve(shapeCenter, centers[i], rotation);
+        offsets[child] = { shapeCenter.x - previous.x, shapeCenter.y - previous.y };
+        bounds.xMin += offsets[child].x;
+        bounds.xMax += offsets[child].x;
+        bounds.yMin += offsets[child].y;
+        bounds.yMax += offsets[child].y;
+      }
+      else
+      {
+        shape->rotate(angle);
+        point_t shapeCenter = shape->getFrameRect().pos;
+        addition::revolve(shapeCenter, centers[i], rotation);
+        shape->move(shapeCenter);
+        bounds = getBounds(shape->getFrameRect());
+      }
+      if (first)
+      {
+        frames[i] = bounds;
+        first = false;
+      }
+      else
+      {
+        unite(frames[i], bounds);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < count; i++)
+  {
+    CompositeShape& node = *nodes_[i].shape;
+    const point_t offset = offsets[i];
+    for (size_t j = 0; j < node.size_; j++)
+    {
+      Shape* shape = node.array_[j].get();
+      if (shape == nullptr)
+      {
+        continue;
+      }
+      if (typeid(*shape) == typeid(CompositeShape))
+      {
+        point_t& childOffset = offsets[nodeIndex[shape]];
+        childOffset.x += offset.x;
+        childOffset.y += offset.y;
+      }
+      else if (offset.x != 0 || offset.y != 0)
+      {
+        shape->move(offset.x, offset.y);
+      }
+    }
+    node.bounds_ = { frames[i].xMin + offset.x, frames[i].yMin + offset.y, frames[i].xMax + offset.x,
+        frames[i].yMax + offset.y };
+    node.boundsValid_ = true;
+    node.indexValid_ = false;
+  }
+  reviseTree();
+}
+
+void grechin::CompositeShape::reviseTree() const
+{
+  // Nested composites may also be held by other parents, which must see the new geometry. Entries of
+  // this tree that were in sync move to the new revision, so the tree does not recompute its caches.
+  for (const node_t& node : nodes_)
+  {
+    node.shape->recordLeaves();
+  }
+  std::vector<bool> synced;
+  for (const node_t& node : nodes_)
+  {
+    for (const child_t& child : node.shape->nested_)
+    {
+      synced.push_back(child.revision == child.shape->getRevision());
+    }
+  }
+
+  const uint64_t revision = nextRevision();
+  size_t entry = 0;
+  for (size_t i = 0; i < nodes_.size(); i++)
+  {
+    const CompositeShape& node = *nodes_[i].shape;
+    for (child_t& child : node.nested_)
+    {
+      if (synced[entry++])
+      {
+        child.revision = revision;
+      }
+    }
+    if (i != 0)
+    {
+      node.revision_ = revision;
+      node.observed_ = true;
+    }
   }
 }
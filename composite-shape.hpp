@@ -1,14 +1,31 @@
 #ifndef COMPOSITE_SHAPE_HPP
 #define COMPOSITE_SHAPE_HPP
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <cstdint>
+#include <exception>
+#include <vector>
+#include <iterator>
+#include <type_traits>
+#include <utility>
 #include "shape.hpp"
+#include "base-types.hpp"
+#include "parallel.hpp"
+#include "spatial-grid.hpp"
+#include "arena.hpp"
+#include "instrumentation.hpp"
+#include "union-area.hpp"
 
 namespace grechin
 {
-  struct rectangle_t;
-  struct point_t;
-  
+  class Circle;
+  class Rectangle;
+
+  // Bounds, area, the spatial index and deferred transforms are all filled in lazily, so even const calls
+  // write to the object. It is therefore not safe to read from several threads at once; share a composite
+  // between threads through ConcurrentCompositeShape, whose snapshots are prepared before they are published.
   class CompositeShape : public Shape
   {
   public:
@@ -23,21 +40,268 @@ namespace grechin
 
     double getArea() const override;
     size_t getSize() const;
+    size_t getCapacity() const;
+    bool isCompensated() const;
+    void setCompensated(const bool);
+    execution_policy_t getExecutionPolicy() const;
+    void setExecutionPolicy(const execution_policy_t&);
+    ArenaPointer getArena() const;
+    void setArena(const ArenaPointer&);
     rectangle_t getFrameRect() const override;
 
     void add(const std::shared_ptr<Shape>&);
+    void add(std::shared_ptr<Shape>&&);
+    template <typename InputIt>
+    void add(InputIt, InputIt);
+    // Emplaced children come from a monotonic arena that never reuses memory, even after remove(). It is
+    // released only once the composite is destroyed and the last handle to an emplaced child is gone. A
+    // composite that keeps replacing children should be given a pool resource through setArena().
+    std::shared_ptr<Circle> emplaceCircle(const double, const point_t&);
+    std::shared_ptr<Rectangle> emplaceRectangle(const double, const double, const point_t&, const double = 0);
     void remove(const size_t);
+    void swapRemove(const size_t);
+    template <typename Predicate>
+    size_t removeIf(Predicate);
+    size_t removeIndices(const std::vector<size_t>&);
+    void markRemoved(const size_t);
+    void reserve(const size_t);
+    void shrink_to_fit();
+    // Edits to circles, rectangles and nested composites made through a handle show up on the next read.
+    // Other Shape types carry no revision, so a child of such a type edited in place needs refresh().
+    void refresh();
+    void flush() const;
+    void prepare() const;
 
     void move(const point_t&) override;
     void move(const double, const double) override;
     void scale(const double) override;
     void rotate(const double) override;
+
+    size_t getLeafCount() const;
+    template <typename Function>
+    void forEachLeaf(Function) const;
+    double getUnionArea() const;
+    union_area_t getUnionArea(const double) const;
+
+    std::vector<size_t> queryOverlapping(const rectangle_t&) const;
+    std::vector<size_t> queryPoint(const point_t&) const;
+    std::vector<size_t> nearest(const point_t&, const size_t) const;
     
   private:
-    typedef std::unique_ptr<std::shared_ptr<Shape>[]> ShapeArray;
-    size_t size_;
-    ShapeArray array_;
+    typedef std::shared_ptr<std::shared_ptr<Shape>[]> ShapeArray;
+
+    struct bounds_t
+    {
+      double xMin;
+      double yMin;
+      double xMax;
+      double yMax;
+    };
+
+    struct transform_t
+    {
+      double xx;
+      double xy;
+      double yx;
+      double yy;
+      point_t offset;
+      double scale;
+      double angle;
+    };
+
+    struct node_t
+    {
+      CompositeShape* shape;
+      uint64_t version;
+    };
+
+    struct leaf_t
+    {
+      Shape* shape;
+      size_t count;
+    };
+
+    struct child_t
+    {
+      const CompositeShape* shape;
+      uint64_t revision;
+    };
+
+    mutable size_t size_;
+    size_t capacity_;
+    mutable ShapeArray array_;
+    mutable bounds_t bounds_;
+    mutable bool boundsValid_;
+    mutable double area_;
+    mutable double areaError_;
+    bool compensated_;
+    execution_policy_t policy_;
+    mutable SpatialGrid index_;
+    mutable std::atomic<bool> indexValid_;
+    mutable std::mutex indexMutex_;
+    ArenaPointer arena_;
+    mutable transform_t transform_;
+    mutable bool transformed_;
+    size_t compositeCount_;
+    size_t customCount_;
+    mutable size_t dead_;
+    mutable bool shared_;
+    mutable uint64_t version_;
+    mutable uint64_t revision_;
+    mutable bool observed_;
+    mutable std::atomic<uint64_t> deepRevision_;
+    mutable std::atomic<uint64_t> deepVersion_;
+    mutable std::vector<child_t> nested_;
+    mutable bool stale_;
+    mutable std::atomic<uint64_t> synced_;
+    mutable std::atomic<uint64_t> checked_;
+    mutable uint64_t leafRevision_;
+    mutable std::atomic<uint64_t> leafEdits_;
+    mutable std::vector<node_t> nodes_;
+    mutable std::vector<leaf_t> leaves_;
+    mutable bool aliased_;
+
+    static bounds_t getBounds(const rectangle_t&);
+    static void unite(bounds_t&, const bounds_t&);
+    static transform_t getIdentity();
+    static void transformShape(Shape&, const transform_t&);
+    static void untransformShape(Shape&, const transform_t&);
+    static std::shared_ptr<Shape> cloneShape(const std::shared_ptr<Shape>&);
+
+    template <typename Function>
+    void forEachChild(Function) const;
+    template <typename Function>
+    void compactIf(Function) const;
+    void compact() const;
+    void applyTransform() const;
+    void detach(const size_t);
+    void resetIfEmpty();
+    void checkEmpty() const;
+    void checkShape(const std::shared_ptr<Shape>&) const;
+    void countShape(const Shape&, const bool);
+    void extendBounds(const rectangle_t&) const;
+    void computeBounds() const;
+    const SpatialGrid& getIndex() const;
+    void computeArea() const;
+    void addArea(const double) const;
+    void reallocate(const size_t);
+    void unshare() const;
+    void cloneChildren() const;
+    void grow();
+    void touch() const;
+    void markChanged() const;
+    uint64_t nextRevision() const;
+    uint64_t getRevision() const;
+    bool isNestedChanged() const;
+    void syncNested() const;
+    void recordNested() const;
+    uint64_t sumLeaves() const;
+    void syncLeaves() const;
+    void recordLeaves() const;
+    bool isPlanValid() const;
+    void buildPlan() const;
+    void flushNodes(const bool) const;
+    void transformTree(const transform_t&) const;
+    void rotateTree(const double, const point_t&) const;
+    void reviseTree() const;
   };
 }
 
+template <typename InputIt>
+void grechin::CompositeShape::add(InputIt first, InputIt last)
+{
+  typedef typename std::iterator_traits<InputIt>::iterator_category Category;
+  if constexpr (std::is_base_of<std::forward_iterator_tag, Category>::value)
+  {
+    reserve(size_ + static_cast<size_t>(std::distance(first, last)));
+  }
+  for (; first != last; ++first)
+  {
+    add(*first);
+  }
+}
+
+template <typename Predicate>
+size_t grechin::CompositeShape::removeIf(Predicate predicate)
+{
+  GRECHIN_INSTRUMENT_CALL(compositeRemove);
+  flush();
+  unshare();
+  const size_t size = size_;
+  compactIf([this, &predicate](const size_t number)
+  {
+    if (predicate(static_cast<const std::shared_ptr<Shape>&>(array_[number])))
+    {
+      detach(number);
+      return true;
+    }
+    return false;
+  });
+  if (size_ != size)
+  {
+    indexValid_ = false;
+    touch();
+  }
+  resetIfEmpty();
+  return size - size_;
+}
+
+template <typename Function>
+void grechin::CompositeShape::forEachLeaf(Function function) const
+{
+  flush();
+  flushNodes(false);
+  for (const leaf_t& leaf : leaves_)
+  {
+    function(static_cast<const Shape&>(*leaf.shape), leaf.count);
+  }
+}
+
+template <typename Function>
+void grechin::CompositeShape::compactIf(Function function) const
+{
+  GRECHIN_INSTRUMENT_CHILDREN(size_);
+  size_t kept = 0;
+  size_t number = 0;
+  std::exception_ptr error = nullptr;
+  for (; number < size_; number++)
+  {
+    bool removed = false;
+    try
+    {
+      removed = function(number);
+    }
+    catch (...)
+    {
+      error = std::current_exception();
+      break;
+    }
+    if (!removed)
+    {
+      if (kept != number)
+      {
+        array_[kept] = std::move(array_[number]);
+      }
+      kept++;
+    }
+  }
+  for (; number < size_; number++)
+  {
+    if (kept != number)
+    {
+      array_[kept] = std::move(array_[number]);
+    }
+    kept++;
+  }
+  for (size_t i = kept; i < size_; i++)
+  {
+    array_[i].reset();
+  }
+  size_ = kept;
+  if (error)
+  {
+    std::rethrow_exception(error);
+  }
+}
+
 #endif
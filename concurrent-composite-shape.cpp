@@ -0,0 +1,95 @@
+#include "concurrent-composite-shape.hpp"
+
+#include <atomic>
+#include <utility>
+
+grechin::ConcurrentCompositeShape::ConcurrentCompositeShape()
+{
+  CompositeShape draft;
+  publish(draft);
+}
+
+grechin::ConcurrentCompositeShape::ConcurrentCompositeShape(const CompositeShape& shape)
+{
+  CompositeShape draft(shape);
+  publish(draft);
+}
+
+grechin::ConcurrentCompositeShape::Snapshot grechin::ConcurrentCompositeShape::getSnapshot() const
+{
+  return std::atomic_load_explicit(&snapshot_, std::memory_order_acquire);
+}
+
+double grechin::ConcurrentCompositeShape::getArea() const
+{
+  return getSnapshot()->getArea();
+}
+
+grechin::rectangle_t grechin::ConcurrentCompositeShape::getFrameRect() const
+{
+  return getSnapshot()->getFrameRect();
+}
+
+size_t grechin::ConcurrentCompositeShape::getSize() const
+{
+  return getSnapshot()->getSize();
+}
+
+void grechin::ConcurrentCompositeShape::add(const std::shared_ptr<Shape>& shape)
+{
+  update([&shape](CompositeShape& draft)
+  {
+    draft.add(shape);
+  });
+}
+
+void grechin::ConcurrentCompositeShape::remove(const size_t number)
+{
+  update([number](CompositeShape& draft)
+  {
+    draft.remove(number);
+  });
+}
+
+void grechin::ConcurrentCompositeShape::move(const point_t& point)
+{
+  update([&point](CompositeShape& draft)
+  {
+    draft.move(point);
+  });
+}
+
+void grechin::ConcurrentCompositeShape::move(const double xMove, const double yMove)
+{
+  update([xMove, yMove](CompositeShape& draft)
+  {
+    draft.move(xMove, yMove);
+  });
+}
+
+void grechin::ConcurrentCompositeShape::scale(const double coefficient)
+{
+  update([coefficient](CompositeShape& draft)
+  {
+    draft.scale(coefficient);
+  });
+}
+
+void grechin::ConcurrentCompositeShape::rotate(const double angle)
+{
+  update([angle](CompositeShape& draft)
+  {
+    draft.rotate(angle);
+  });
+}
+
+void grechin::ConcurrentCompositeShape::publish(CompositeShape& draft)
+{
+  // Pending transforms are applied to the draft first, which clones the children that published
+  // snapshots still hold instead of changing them in place
+  draft.flush();
+  std::shared_ptr<CompositeShape> snapshot = std::make_shared<CompositeShape>(draft);
+  snapshot->prepare();
+  shape_ = std::move(draft);
+  std::atomic_store_explicit(&snapshot_, Snapshot(std::move(snapshot)), std::memory_order_release);
+}
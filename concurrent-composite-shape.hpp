@@ -0,0 +1,61 @@
+#ifndef CONCURRENT_COMPOSITE_SHAPE_HPP
+#define CONCURRENT_COMPOSITE_SHAPE_HPP
+
+#include <memory>
+#include <mutex>
+#include "composite-shape.hpp"
+#include "base-types.hpp"
+
+namespace grechin
+{
+  // Edits go to a private CompositeShape under the writer mutex and are published as a prepared
+  // copy-on-write snapshot. Readers only load the current snapshot, so they never wait for an edit,
+  // and a snapshot does not change while it is held.
+  class ConcurrentCompositeShape
+  {
+  public:
+    typedef std::shared_ptr<const CompositeShape> Snapshot;
+
+    ConcurrentCompositeShape();
+    explicit ConcurrentCompositeShape(const CompositeShape&);
+    ConcurrentCompositeShape(const ConcurrentCompositeShape&) = delete;
+    ~ConcurrentCompositeShape() = default;
+
+    ConcurrentCompositeShape& operator=(const ConcurrentCompositeShape&) = delete;
+
+    Snapshot getSnapshot() const;
+    double getArea() const;
+    rectangle_t getFrameRect() const;
+    size_t getSize() const;
+
+    void add(const std::shared_ptr<Shape>&);
+    void remove(const size_t);
+    void move(const point_t&);
+    void move(const double, const double);
+    void scale(const double);
+    void rotate(const double);
+    // Applies several edits as one publication. Children reached through operator[] are shared with
+    // published snapshots and must be replaced rather than modified. A nested composite edited through a
+    // handle kept outside shows up in the next read, but only if no reader runs at the same time.
+    template <typename Function>
+    void update(Function);
+
+  private:
+    mutable std::mutex mutex_;
+    CompositeShape shape_;
+    Snapshot snapshot_;
+
+    void publish(CompositeShape&);
+  };
+}
+
+template <typename Function>
+void grechin::ConcurrentCompositeShape::update(Function function)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  CompositeShape draft(shape_);
+  function(draft);
+  publish(draft);
+}
+
+#endif
@@ -0,0 +1,307 @@
+#include "flat-composite.hpp"
+
+#include <algorithm>
+#include <typeinfo>
+#include <utility>
+#include <stdexcept>
+#include "composite-shape.hpp"
+
+namespace
+{
+  struct area_t
+  {
+    double operator()(const grechin::Circle& shape) const
+    {
+      return shape.grechin::Circle::getArea();
+    }
+    double operator()(const grechin::Rectangle& shape) const
+    {
+      return shape.grechin::Rectangle::getArea();
+    }
+    double operator()(const std::shared_ptr<grechin::CompositeShape>& shape) const
+    {
+      return shape->getArea();
+    }
+  };
+
+  struct frame_t
+  {
+    grechin::rectangle_t operator()(const grechin::Circle& shape) const
+    {
+      return shape.grechin::Circle::getFrameRect();
+    }
+    grechin::rectangle_t operator()(const grechin::Rectangle& shape) const
+    {
+      return shape.grechin::Rectangle::getFrameRect();
+    }
+    grechin::rectangle_t operator()(const std::shared_ptr<grechin::CompositeShape>& shape) const
+    {
+      return shape->getFrameRect();
+    }
+  };
+
+  grechin::CompositeShape& unshare(std::shared_ptr<grechin::CompositeShape>& shape)
+  {
+    if (shape.use_count() > 1)
+    {
+      shape = std::make_shared<grechin::CompositeShape>(*shape);
+    }
+    return *shape;
+  }
+
+  struct move_t
+  {
+    double xMove;
+    double yMove;
+    void operator()(grechin::Circle& shape) const
+    {
+      shape.grechin::Circle::move(xMove, yMove);
+    }
+    void operator()(grechin::Rectangle& shape) const
+    {
+      shape.grechin::Rectangle::move(xMove, yMove);
+    }
+    void operator()(std::shared_ptr<grechin::CompositeShape>& shape) const
+    {
+      unshare(shape).move(xMove, yMove);
+    }
+  };
+
+  struct scale_t
+  {
+    double coefficient;
+    void operator()(grechin::Circle& shape) const
+    {
+      shape.grechin::Circle::scale(coefficient);
+    }
+    void operator()(grechin::Rectangle& shape) const
+    {
+      shape.grechin::Rectangle::scale(coefficient);
+    }
+    void operator()(std::shared_ptr<grechin::CompositeShape>& shape) const
+    {
+      unshare(shape).scale(coefficient);
+    }
+  };
+
+  struct rotate_t
+  {
+    double angle;
+    void operator()(grechin::Circle& shape) const
+    {
+      shape.grechin::Circle::rotate(angle);
+    }
+    void operator()(grechin::Rectangle& shape) const
+    {
+      shape.grechin::Rectangle::rotate(angle);
+    }
+    void operator()(std::shared_ptr<grechin::CompositeShape>& shape) const
+    {
+      unshare(shape).rotate(angle);
+    }
+  };
+}
+
+double grechin::getArea(const ShapeValue& shape)
+{
+  return std::visit(area_t{}, shape);
+}
+
+grechin::rectangle_t grechin::getFrameRect(const ShapeValue& shape)
+{
+  return std::visit(frame_t{}, shape);
+}
+
+void grechin::move(ShapeValue& shape, const double xMove, const double yMove)
+{
+  std::visit(move_t{ xMove, yMove }, shape);
+}
+
+void grechin::scale(ShapeValue& shape, const double coefficient)
+{
+  std::visit(scale_t{ coefficient }, shape);
+}
+
+void grechin::rotate(ShapeValue& shape, const double angle)
+{
+  std::visit(rotate_t{ angle }, shape);
+}
+
+grechin::FlatComposite::FlatComposite()
+{}
+
+grechin::FlatComposite::FlatComposite(const CompositeShape& composite)
+{
+  shapes_.reserve(composite.getSize());
+  for (size_t i = 0; i < composite.getSize(); i++)
+  {
+    const std::shared_ptr<Shape> shape = composite[i];
+    const std::type_info& type = typeid(*shape);
+    if (type == typeid(Circle))
+    {
+      shapes_.emplace_back(static_cast<const Circle&>(*shape));
+    }
+    else if (type == typeid(Rectangle))
+    {
+      shapes_.emplace_back(static_cast<const Rectangle&>(*shape));
+    }
+    else if (type == typeid(CompositeShape))
+    {
+      shapes_.emplace_back(std::static_pointer_cast<CompositeShape>(shape));
+    }
+    else
+    {
+      throw std::invalid_argument("Unsupported shape type");
+    }
+  }
+}
+
+const grechin::ShapeValue& grechin::FlatComposite::operator[](const size_t number) const
+{
+  if (number >= shapes_.size())
+  {
+    throw std::out_of_range("Out of range");
+  }
+  return shapes_[number];
+}
+
+double grechin::FlatComposite::getArea() const
+{
+  double area = 0;
+  for (const ShapeValue& shape : shapes_)
+  {
+    area += grechin::getArea(shape);
+  }
+  return area;
+}
+
+grechin::rectangle_t grechin::FlatComposite::getFrameRect() const
+{
+  if (shapes_.empty())
+  {
+    return rectangle_t{ 0, 0, { 0, 0 } };
+  }
+
+  const rectangle_t first = grechin::getFrameRect(shapes_.front());
+  double xMin = first.pos.x - first.width / 2;
+  double yMin = first.pos.y - first.height / 2;
+  double xMax = first.pos.x + first.width / 2;
+  double yMax = first.pos.y + first.height / 2;
+  for (size_t i = 1; i < shapes_.size(); i++)
+  {
+    const rectangle_t frame = grechin::getFrameRect(shapes_[i]);
+    xMin = std::min(xMin, frame.pos.x - frame.width / 2);
+    yMin = std::min(yMin, frame.pos.y - frame.height / 2);
+    xMax = std::max(xMax, frame.pos.x + frame.width / 2);
+    yMax = std::max(yMax, frame.pos.y + frame.height / 2);
+  }
+  return rectangle_t{ xMax - xMin, yMax - yMin, { (xMax + xMin) / 2, (yMax + yMin) / 2 } };
+}
+
+size_t grechin::FlatComposite::getSize() const
+{
+  return shapes_.size();
+}
+
+void grechin::FlatComposite::add(const ShapeValue& shape)
+{
+  checkShape(shape);
+  shapes_.push_back(shape);
+}
+
+void grechin::FlatComposite::add(ShapeValue&& shape)
+{
+  checkShape(shape);
+  shapes_.push_back(std::move(shape));
+}
+
+void grechin::FlatComposite::remove(const size_t number)
+{
+  if (number >= shapes_.size())
+  {
+    throw std::out_of_range("Out of range");
+  }
+  shapes_.erase(shapes_.begin() + number);
+}
+
+void grechin::FlatComposite::reserve(const size_t capacity)
+{
+  shapes_.reserve(capacity);
+}
+
+void grechin::FlatComposite::move(const point_t& movePoint)
+{
+  if (shapes_.empty())
+  {
+    throw std::logic_error("FlatComposite is empty");
+  }
+
+  const point_t center = getFrameRect().pos;
+  move(movePoint.x - center.x, movePoint.y - center.y);
+}
+
+void grechin::FlatComposite::move(const double xMove, const double yMove)
+{
+  if (shapes_.empty())
+  {
+    throw std::logic_error("FlatComposite is empty");
+  }
+
+  const move_t visitor = { xMove, yMove };
+  for (ShapeValue& shape : shapes_)
+  {
+    std::visit(visitor, shape);
+  }
+}
+
+void grechin::FlatComposite::scale(const double coefficient)
+{
+  if (coefficient <= 0)
+  {
+    throw std::invalid_argument("Coefficient must be > 0");
+  }
+  if (shapes_.empty())
+  {
+    throw std::logic_error("FlatComposite is empty");
+  }
+
+  const point_t center = getFrameRect().pos;
+  const scale_t visitor = { coefficient };
+  for (ShapeValue& shape : shapes_)
+  {
+    std::visit(visitor, shape);
+    const point_t shapeCenter = grechin::getFrameRect(shape).pos;
+    const double xMove = (shapeCenter.x - center.x) * (coefficient - 1);
+    const double yMove = (shapeCenter.y - center.y) * (coefficient - 1);
+    std::visit(move_t{ xMove, yMove }, shape);
+  }
+}
+
+void grechin::FlatComposite::rotate(const double angle)
+{
+  if (shapes_.empty())
+  {
+    throw std::logic_error("FlatComposite is empty");
+  }
+
+  const point_t center = getFrameRect().pos;
+  const rotation_t rotation = addition::getRotation(angle);
+  const rotate_t visitor = { angle };
+  for (ShapeValue& shape : shapes_)
+  {
+    std::visit(visitor, shape);
+    const point_t shapeCenter = grechin::getFrameRect(shape).pos;
+    point_t newCenter = shapeCenter;
+    addition::revolve(newCenter, center, rotation);
+    std::visit(move_t{ newCenter.x - shapeCenter.x, newCenter.y - shapeCenter.y }, shape);
+  }
+}
+
+void grechin::FlatComposite::checkShape(const ShapeValue& shape)
+{
+  const std::shared_ptr<CompositeShape>* composite = std::get_if<std::shared_ptr<CompositeShape>>(&shape);
+  if (composite != nullptr && *composite == nullptr)
+  {
+    throw std::invalid_argument("Shape must not be nullptr");
+  }
+}
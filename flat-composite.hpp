@@ -0,0 +1,53 @@
+#ifndef FLAT_COMPOSITE_HPP
+#define FLAT_COMPOSITE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <variant>
+#include <vector>
+#include "shape.hpp"
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "base-types.hpp"
+
+namespace grechin
+{
+  class CompositeShape;
+
+  typedef std::variant<Circle, Rectangle, std::shared_ptr<CompositeShape>> ShapeValue;
+
+  double getArea(const ShapeValue&);
+  rectangle_t getFrameRect(const ShapeValue&);
+  void move(ShapeValue&, const double, const double);
+  void scale(ShapeValue&, const double);
+  void rotate(ShapeValue&, const double);
+
+  class FlatComposite : public Shape
+  {
+  public:
+    FlatComposite();
+    explicit FlatComposite(const CompositeShape&);
+
+    const ShapeValue& operator[](const size_t) const;
+    double getArea() const override;
+    rectangle_t getFrameRect() const override;
+    size_t getSize() const;
+
+    void add(const ShapeValue&);
+    void add(ShapeValue&&);
+    void remove(const size_t);
+    void reserve(const size_t);
+
+    void move(const point_t&) override;
+    void move(const double, const double) override;
+    void scale(const double) override;
+    void rotate(const double) override;
+
+  private:
+    std::vector<ShapeValue> shapes_;
+
+    static void checkShape(const ShapeValue&);
+  };
+}
+
+#endif
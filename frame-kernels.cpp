@@ -0,0 +1,446 @@
+#include "frame-kernels.hpp"
+
+#define _USE_MATH_DEFINES
+
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GRECHIN_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+  using grechin::kernels::Isa;
+  using grechin::kernels::bounds_t;
+
+  Isa detectIsa()
+  {
+#ifdef GRECHIN_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+      return Isa::avx2;
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+      return Isa::sse2;
+    }
+#endif
+    return Isa::scalar;
+  }
+
+  std::atomic<Isa>& currentIsa()
+  {
+    // Kernels may run on worker threads while setIsa is called, so the selector is read and written atomically
+    static std::atomic<Isa> isa(detectIsa());
+    return isa;
+  }
+
+  double circleAreaSumScalar(const double* radius, const size_t count)
+  {
+    double sum = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+      sum += M_PI * radius[i] * radius[i];
+    }
+    return sum;
+  }
+
+  double rectangleAreaSumScalar(const double* width, const double* height, const size_t count)
+  {
+    double sum = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+      sum += width[i] * height[i];
+    }
+    return sum;
+  }
+
+  void rectangleFramesScalar(const double* width, const double* height, const double* cosAngle,
+      const double* sinAngle, const size_t count, double* frameWidth, double* frameHeight)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      frameWidth[i] = width[i] * fabs(cosAngle[i]) + height[i] * fabs(sinAngle[i]);
+      frameHeight[i] = width[i] * fabs(sinAngle[i]) + height[i] * fabs(cosAngle[i]);
+    }
+  }
+
+  void circleBoundsScalar(const double* radius, const double* x, const double* y, const size_t count,
+      bounds_t& bounds)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      bounds.xMax = std::max(bounds.xMax, x[i] + radius[i]);
+      bounds.yMax = std::max(bounds.yMax, y[i] + radius[i]);
+      bounds.xMin = std::min(bounds.xMin, x[i] - radius[i]);
+      bounds.yMin = std::min(bounds.yMin, y[i] - radius[i]);
+    }
+  }
+
+  void rectangleBoundsScalar(const double* width, const double* height, const double* x, const double* y,
+      const double* cosAngle, const double* sinAngle, const size_t count, bounds_t& bounds)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      const double frameWidth = width[i] * fabs(cosAngle[i]) + height[i] * fabs(sinAngle[i]);
+      const double frameHeight = width[i] * fabs(sinAngle[i]) + height[i] * fabs(cosAngle[i]);
+      bounds.xMax = std::max(bounds.xMax, x[i] + frameWidth / 2);
+      bounds.yMax = std::max(bounds.yMax, y[i] + frameHeight / 2);
+      bounds.xMin = std::min(bounds.xMin, x[i] - frameWidth / 2);
+      bounds.yMin = std::min(bounds.yMin, y[i] - frameHeight / 2);
+    }
+  }
+
+#ifdef GRECHIN_KERNELS_X86
+  __attribute__((target("sse2")))
+  double horizontalSum(const __m128d value)
+  {
+    double lanes[2];
+    _mm_storeu_pd(lanes, value);
+    return lanes[0] + lanes[1];
+  }
+
+  __attribute__((target("sse2")))
+  double horizontalMax(const __m128d value)
+  {
+    double lanes[2];
+    _mm_storeu_pd(lanes, value);
+    return std::max(lanes[0], lanes[1]);
+  }
+
+  __attribute__((target("sse2")))
+  double horizontalMin(const __m128d value)
+  {
+    double lanes[2];
+    _mm_storeu_pd(lanes, value);
+    return std::min(lanes[0], lanes[1]);
+  }
+
+  __attribute__((target("sse2")))
+  double circleAreaSumSse2(const double* radius, const size_t count)
+  {
+    const __m128d pi = _mm_set1_pd(M_PI);
+    __m128d sum = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+      const __m128d r = _mm_loadu_pd(radius + i);
+      sum = _mm_add_pd(sum, _mm_mul_pd(_mm_mul_pd(pi, r), r));
+    }
+    return horizontalSum(sum) + circleAreaSumScalar(radius + i, count - i);
+  }
+
+  __attribute__((target("sse2")))
+  double rectangleAreaSumSse2(const double* width, const double* height, const size_t count)
+  {
+    __m128d sum = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+      sum = _mm_add_pd(sum, _mm_mul_pd(_mm_loadu_pd(width + i), _mm_loadu_pd(height + i)));
+    }
+    return horizontalSum(sum) + rectangleAreaSumScalar(width + i, height + i, count - i);
+  }
+
+  __attribute__((target("sse2")))
+  void rectangleFramesSse2(const double* width, const double* height, const double* cosAngle,
+      const double* sinAngle, const size_t count, double* frameWidth, double* frameHeight)
+  {
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+      const __m128d w = _mm_loadu_pd(width + i);
+      const __m128d h = _mm_loadu_pd(height + i);
+      const __m128d c = _mm_andnot_pd(signMask, _mm_loadu_pd(cosAngle + i));
+      const __m128d s = _mm_andnot_pd(signMask, _mm_loadu_pd(sinAngle + i));
+      _mm_storeu_pd(frameWidth + i, _mm_add_pd(_mm_mul_pd(w, c), _mm_mul_pd(h, s)));
+      _mm_storeu_pd(frameHeight + i, _mm_add_pd(_mm_mul_pd(w, s), _mm_mul_pd(h, c)));
+    }
+    rectangleFramesScalar(width + i, height + i, cosAngle + i, sinAngle + i, count - i, frameWidth + i,
+        frameHeight + i);
+  }
+
+  __attribute__((target("sse2")))
+  void circleBoundsSse2(const double* radius, const double* x, const double* y, const size_t count,
+      bounds_t& bounds)
+  {
+    __m128d xMax = _mm_set1_pd(bounds.xMax);
+    __m128d yMax = _mm_set1_pd(bounds.yMax);
+    __m128d xMin = _mm_set1_pd(bounds.xMin);
+    __m128d yMin = _mm_set1_pd(bounds.yMin);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+      const __m128d r = _mm_loadu_pd(radius + i);
+      const __m128d cx = _mm_loadu_pd(x + i);
+      const __m128d cy = _mm_loadu_pd(y + i);
+      xMax = _mm_max_pd(xMax, _mm_add_pd(cx, r));
+      yMax = _mm_max_pd(yMax, _mm_add_pd(cy, r));
+      xMin = _mm_min_pd(xMin, _mm_sub_pd(cx, r));
+      yMin = _mm_min_pd(yMin, _mm_sub_pd(cy, r));
+    }
+    bounds = bounds_t{ horizontalMin(xMin), horizontalMin(yMin), horizontalMax(xMax), horizontalMax(yMax) };
+    circleBoundsScalar(radius + i, x + i, y + i, count - i, bounds);
+  }
+
+  __attribute__((target("sse2")))
+  void rectangleBoundsSse2(const double* width, const double* height, const double* x, const double* y,
+      const double* cosAngle, const double* sinAngle, const size_t count, bounds_t& bounds)
+  {
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    const __m128d half = _mm_set1_pd(0.5);
+    __m128d xMax = _mm_set1_pd(bounds.xMax);
+    __m128d yMax = _mm_set1_pd(bounds.yMax);
+    __m128d xMin = _mm_set1_pd(bounds.xMin);
+    __m128d yMin = _mm_set1_pd(bounds.yMin);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+      const __m128d w = _mm_loadu_pd(width + i);
+      const __m128d h = _mm_loadu_pd(height + i);
+      const __m128d c = _mm_andnot_pd(signMask, _mm_loadu_pd(cosAngle + i));
+      const __m128d s = _mm_andnot_pd(signMask, _mm_loadu_pd(sinAngle + i));
+      const __m128d halfWidth = _mm_mul_pd(_mm_add_pd(_mm_mul_pd(w, c), _mm_mul_pd(h, s)), half);
+      const __m128d halfHeight = _mm_mul_pd(_mm_add_pd(_mm_mul_pd(w, s), _mm_mul_pd(h, c)), half);
+      const __m128d cx = _mm_loadu_pd(x + i);
+      const __m128d cy = _mm_loadu_pd(y + i);
+      xMax = _mm_max_pd(xMax, _mm_add_pd(cx, halfWidth));
+      yMax = _mm_max_pd(yMax, _mm_add_pd(cy, halfHeight));
+      xMin = _mm_min_pd(xMin, _mm_sub_pd(cx, halfWidth));
+      yMin = _mm_min_pd(yMin, _mm_sub_pd(cy, halfHeight));
+    }
+    bounds = bounds_t{ horizontalMin(xMin), horizontalMin(yMin), horizontalMax(xMax), horizontalMax(yMax) };
+    rectangleBoundsScalar(width + i, height + i, x + i, y + i, cosAngle + i, sinAngle + i, count - i, bounds);
+  }
+
+  __attribute__((target("avx2")))
+  __m128d foldLanes(const __m256d value)
+  {
+    return _mm_add_pd(_mm256_castpd256_pd128(value), _mm256_extractf128_pd(value, 1));
+  }
+
+  __attribute__((target("avx2")))
+  double circleAreaSumAvx2(const double* radius, const size_t count)
+  {
+    const __m256d pi = _mm256_set1_pd(M_PI);
+    __m256d sum = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+      const __m256d r = _mm256_loadu_pd(radius + i);
+      sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_mul_pd(pi, r), r));
+    }
+    return horizontalSum(foldLanes(sum)) + circleAreaSumScalar(radius + i, count - i);
+  }
+
+  __attribute__((target("avx2")))
+  double rectangleAreaSumAvx2(const double* width, const double* height, const size_t count)
+  {
+    __m256d sum = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+      sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_loadu_pd(width + i), _mm256_loadu_pd(height + i)));
+    }
+    return horizontalSum(foldLanes(sum)) + rectangleAreaSumScalar(width + i, height + i, count - i);
+  }
+
+  __attribute__((target("avx2")))
+  void rectangleFramesAvx2(const double* width, const double* height, const double* cosAngle,
+      const double* sinAngle, const size_t count, double* frameWidth, double* frameHeight)
+  {
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+      const __m256d w = _mm256_loadu_pd(width + i);
+      const __m256d h = _mm256_loadu_pd(height + i);
+      const __m256d c = _mm256_andnot_pd(signMask, _mm256_loadu_pd(cosAngle + i));
+      const __m256d s = _mm256_andnot_pd(signMask, _mm256_loadu_pd(sinAngle + i));
+      _mm256_storeu_pd(frameWidth + i, _mm256_add_pd(_mm256_mul_pd(w, c), _mm256_mul_pd(h, s)));
+      _mm256_storeu_pd(frameHeight + i, _mm256_add_pd(_mm256_mul_pd(w, s), _mm256_mul_pd(h, c)));
+    }
+    rectangleFramesScalar(width + i, height + i, cosAngle + i, sinAngle + i, count - i, frameWidth + i,
+        frameHeight + i);
+  }
+
+  __attribute__((target("avx2")))
+  void reduceBounds(const __m256d xMin, const __m256d yMin, const __m256d xMax, const __m256d yMax,
+      bounds_t& bounds)
+  {
+    const __m128d xMinPair = _mm_min_pd(_mm256_castpd256_pd128(xMin), _mm256_extractf128_pd(xMin, 1));
+    const __m128d yMinPair = _mm_min_pd(_mm256_castpd256_pd128(yMin), _mm256_extractf128_pd(yMin, 1));
+    const __m128d xMaxPair = _mm_max_pd(_mm256_castpd256_pd128(xMax), _mm256_extractf128_pd(xMax, 1));
+    const __m128d yMaxPair = _mm_max_pd(_mm256_castpd256_pd128(yMax), _mm256_extractf128_pd(yMax, 1));
+    bounds = bounds_t{ horizontalMin(xMinPair), horizontalMin(yMinPair), horizontalMax(xMaxPair),
+        horizontalMax(yMaxPair) };
+  }
+
+  __attribute__((target("avx2")))
+  void circleBoundsAvx2(const double* radius, const double* x, const double* y, const size_t count,
+      bounds_t& bounds)
+  {
+    __m256d xMax = _mm256_set1_pd(bounds.xMax);
+    __m256d yMax = _mm256_set1_pd(bounds.yMax);
+    __m256d xMin = _mm256_set1_pd(bounds.xMin);
+    __m256d yMin = _mm256_set1_pd(bounds.yMin);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+      const __m256d r = _mm256_loadu_pd(radius + i);
+      const __m256d cx = _mm256_loadu_pd(x + i);
+      const __m256d cy = _mm256_loadu_pd(y + i);
+      xMax = _mm256_max_pd(xMax, _mm256_add_pd(cx, r));
+      yMax = _mm256_max_pd(yMax, _mm256_add_pd(cy, r));
+      xMin = _mm256_min_pd(xMin, _mm256_sub_pd(cx, r));
+      yMin = _mm256_min_pd(yMin, _mm256_sub_pd(cy, r));
+    }
+    reduceBounds(xMin, yMin, xMax, yMax, bounds);
+    circleBoundsScalar(radius + i, x + i, y + i, count - i, bounds);
+  }
+
+  __attribute__((target("avx2")))
+  void rectangleBoundsAvx2(const double* width, const double* height, const double* x, const double* y,
+      const double* cosAngle, const double* sinAngle, const size_t count, bounds_t& bounds)
+  {
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    const __m256d half = _mm256_set1_pd(0.5);
+    __m256d xMax = _mm256_set1_pd(bounds.xMax);
+    __m256d yMax = _mm256_set1_pd(bounds.yMax);
+    __m256d xMin = _mm256_set1_pd(bounds.xMin);
+    __m256d yMin = _mm256_set1_pd(bounds.yMin);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+      const __m256d w = _mm256_loadu_pd(width + i);
+      const __m256d h = _mm256_loadu_pd(height + i);
+      const __m256d c = _mm256_andnot_pd(signMask, _mm256_loadu_pd(cosAngle + i));
+      const __m256d s = _mm256_andnot_pd(signMask, _mm256_loadu_pd(sinAngle + i));
+      const __m256d halfWidth = _mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(w, c), _mm256_mul_pd(h, s)), half);
+      const __m256d halfHeight = _mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(w, s), _mm256_mul_pd(h, c)), half);
+      const __m256d cx = _mm256_loadu_pd(x + i);
+      const __m256d cy = _mm256_loadu_pd(y + i);
+      xMax = _mm256_max_pd(xMax, _mm256_add_pd(cx, halfWidth));
+      yMax = _mm256_max_pd(yMax, _mm256_add_pd(cy, halfHeight));
+      xMin = _mm256_min_pd(xMin, _mm256_sub_pd(cx, halfWidth));
+      yMin = _mm256_min_pd(yMin, _mm256_sub_pd(cy, halfHeight));
+    }
+    reduceBounds(xMin, yMin, xMax, yMax, bounds);
+    rectangleBoundsScalar(width + i, height + i, x + i, y + i, cosAngle + i, sinAngle + i, count - i, bounds);
+  }
+#endif
+}
+
+bool grechin::kernels::isSupported(const Isa isa)
+{
+  return static_cast<int>(isa) <= static_cast<int>(detectIsa());
+}
+
+grechin::kernels::Isa grechin::kernels::getIsa()
+{
+  return currentIsa().load(std::memory_order_relaxed);
+}
+
+void grechin::kernels::setIsa(const Isa isa)
+{
+  if (!isSupported(isa))
+  {
+    throw std::invalid_argument("Instruction set is not supported");
+  }
+  currentIsa().store(isa, std::memory_order_relaxed);
+}
+
+grechin::kernels::bounds_t grechin::kernels::getEmptyBounds()
+{
+  return bounds_t{ INFINITY, INFINITY, -INFINITY, -INFINITY };
+}
+
+double grechin::kernels::circleAreaSum(const double* radius, const size_t count)
+{
+  switch (currentIsa().load(std::memory_order_relaxed))
+  {
+#ifdef GRECHIN_KERNELS_X86
+  case Isa::avx2:
+    return circleAreaSumAvx2(radius, count);
+  case Isa::sse2:
+    return circleAreaSumSse2(radius, count);
+#endif
+  default:
+    return circleAreaSumScalar(radius, count);
+  }
+}
+
+double grechin::kernels::rectangleAreaSum(const double* width, const double* height, const size_t count)
+{
+  switch (currentIsa().load(std::memory_order_relaxed))
+  {
+#ifdef GRECHIN_KERNELS_X86
+  case Isa::avx2:
+    return rectangleAreaSumAvx2(width, height, count);
+  case Isa::sse2:
+    return rectangleAreaSumSse2(width, height, count);
+#endif
+  default:
+    return rectangleAreaSumScalar(width, height, count);
+  }
+}
+
+void grechin::kernels::rectangleFrames(const double* width, const double* height, const double* cosAngle,
+    const double* sinAngle, const size_t count, double* frameWidth, double* frameHeight)
+{
+  switch (currentIsa().load(std::memory_order_relaxed))
+  {
+#ifdef GRECHIN_KERNELS_X86
+  case Isa::avx2:
+    rectangleFramesAvx2(width, height, cosAngle, sinAngle, count, frameWidth, frameHeight);
+    break;
+  case Isa::sse2:
+    rectangleFramesSse2(width, height, cosAngle, sinAngle, count, frameWidth, frameHeight);
+    break;
+#endif
+  default:
+    rectangleFramesScalar(width, height, cosAngle, sinAngle, count, frameWidth, frameHeight);
+  }
+}
+
+void grechin::kernels::circleBounds(const double* radius, const double* x, const double* y, const size_t count,
+    bounds_t& bounds)
+{
+  switch (currentIsa().load(std::memory_order_relaxed))
+  {
+#ifdef GRECHIN_KERNELS_X86
+  case Isa::avx2:
+    circleBoundsAvx2(radius, x, y, count, bounds);
+    break;
+  case Isa::sse2:
+    circleBoundsSse2(radius, x, y, count, bounds);
+    break;
+#endif
+  default:
+    circleBoundsScalar(radius, x, y, count, bounds);
+  }
+}
+
+void grechin::kernels::rectangleBounds(const double* width, const double* height, const double* x,
+    const double* y, const double* cosAngle, const double* sinAngle, const size_t count, bounds_t& bounds)
+{
+  switch (currentIsa().load(std::memory_order_relaxed))
+  {
+#ifdef GRECHIN_KERNELS_X86
+  case Isa::avx2:
+    rectangleBoundsAvx2(width, height, x, y, cosAngle, sinAngle, count, bounds);
+    break;
+  case Isa::sse2:
+    rectangleBoundsSse2(width, height, x, y, cosAngle, sinAngle, count, bounds);
+    break;
+#endif
+  default:
+    rectangleBoundsScalar(width, height, x, y, cosAngle, sinAngle, count, bounds);
+  }
+}
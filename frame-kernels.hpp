@@ -0,0 +1,43 @@
+#ifndef FRAME_KERNELS_HPP
+#define FRAME_KERNELS_HPP
+
+#include <cstddef>
+
+namespace grechin
+{
+  namespace kernels
+  {
+    enum class Isa
+    {
+      scalar,
+      sse2,
+      avx2
+    };
+
+    struct bounds_t
+    {
+      double xMin;
+      double yMin;
+      double xMax;
+      double yMax;
+    };
+
+    bool isSupported(const Isa);
+    Isa getIsa();
+    void setIsa(const Isa);
+
+    bounds_t getEmptyBounds();
+
+    double circleAreaSum(const double*, const size_t);
+    double rectangleAreaSum(const double*, const double*, const size_t);
+
+    void rectangleFrames(const double*, const double*, const double*, const double*, const size_t,
+        double*, double*);
+
+    void circleBounds(const double*, const double*, const double*, const size_t, bounds_t&);
+    void rectangleBounds(const double*, const double*, const double*, const double*, const double*,
+        const double*, const size_t, bounds_t&);
+  }
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include "ingest-buffer.hpp"
+
+#include <exception>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+grechin::IngestBuffer::Producer::Producer(IngestBuffer& buffer) :
+  buffer_(&buffer),
+  chunk_(nullptr)
+{}
+
+grechin::IngestBuffer::Producer::Producer(Producer&& producer) noexcept :
+  buffer_(producer.buffer_),
+  chunk_(producer.chunk_)
+{
+  producer.chunk_ = nullptr;
+}
+
+grechin::IngestBuffer::Producer::~Producer()
+{
+  flush();
+  delete chunk_;
+}
+
+void grechin::IngestBuffer::Producer::push(const std::shared_ptr<Shape>& shape)
+{
+  push(std::shared_ptr<Shape>(shape));
+}
+
+void grechin::IngestBuffer::Producer::push(std::shared_ptr<Shape>&& shape)
+{
+  if (shape == nullptr)
+  {
+    throw std::invalid_argument("Shape must not be nullptr");
+  }
+  if (chunk_ == nullptr)
+  {
+    chunk_ = new chunk_t();
+  }
+  chunk_->shapes[chunk_->end++] = std::move(shape);
+  if (chunk_->end == INGEST_CHUNK)
+  {
+    buffer_->publish(chunk_, chunk_, INGEST_CHUNK);
+    chunk_ = nullptr;
+  }
+}
+
+void grechin::IngestBuffer::Producer::flush()
+{
+  if (chunk_ != nullptr && chunk_->end != 0)
+  {
+    buffer_->publish(chunk_, chunk_, chunk_->end);
+    chunk_ = nullptr;
+  }
+}
+
+grechin::IngestBuffer::IngestBuffer() :
+  head_(nullptr),
+  size_(0)
+{}
+
+grechin::IngestBuffer::~IngestBuffer()
+{
+  chunk_t* chunk = head_.load(std::memory_order_acquire);
+  while (chunk != nullptr)
+  {
+    chunk_t* next = chunk->next;
+    delete chunk;
+    chunk = next;
+  }
+}
+
+size_t grechin::IngestBuffer::getSize() const
+{
+  return size_.load(std::memory_order_relaxed);
+}
+
+size_t grechin::IngestBuffer::commit(CompositeShape& shape)
+{
+  // Only commit detaches chunks and it takes the whole stack at once, so the stack has no ABA problem
+  chunk_t* chunk = head_.exchange(nullptr, std::memory_order_acquire);
+  chunk_t* first = nullptr;
+  size_t count = 0;
+  while (chunk != nullptr)
+  {
+    chunk_t* next = chunk->next;
+    chunk->next = first;
+    first = chunk;
+    count += chunk->end - chunk->begin;
+    chunk = next;
+  }
+  size_.fetch_sub(count, std::memory_order_relaxed);
+  if (count == 0)
+  {
+    return 0;
+  }
+
+  size_t size = shape.getSize();
+  size_t rejected = 0;
+  std::exception_ptr error = nullptr;
+  try
+  {
+    shape.reserve(size + count);
+    for (; first != nullptr; size = shape.getSize())
+    {
+      shape.add(std::make_move_iterator(first->shapes + first->begin),
+          std::make_move_iterator(first->shapes + first->end));
+      chunk_t* next = first->next;
+      delete first;
+      first = next;
+    }
+    return count;
+  }
+  catch (const std::invalid_argument&)
+  {
+    rejected = 1;
+    error = std::current_exception();
+  }
+  catch (...)
+  {
+    error = std::current_exception();
+  }
+
+  // Shapes appended before the failure stay in the composite, a rejected shape is dropped and the rest
+  // are staged again for the next commit. The stack holds the newest chunk on top, so the remaining
+  // chunks go back in reverse and the next commit restores the push order.
+  first->begin += shape.getSize() - size + rejected;
+  size_t left = 0;
+  chunk_t* last = first;
+  chunk_t* top = nullptr;
+  while (first != nullptr)
+  {
+    chunk_t* next = first->next;
+    left += first->end - first->begin;
+    first->next = top;
+    top = first;
+    first = next;
+  }
+  publish(top, last, left);
+  std::rethrow_exception(error);
+}
+
+void grechin::IngestBuffer::publish(chunk_t* first, chunk_t* last, const size_t count)
+{
+  size_.fetch_add(count, std::memory_order_relaxed);
+  chunk_t* head = head_.load(std::memory_order_relaxed);
+  do
+  {
+    last->next = head;
+  }
+  while (!head_.compare_exchange_weak(head, first, std::memory_order_release, std::memory_order_relaxed));
+}
@@ -0,0 +1,66 @@
+#ifndef INGEST_BUFFER_HPP
+#define INGEST_BUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include "shape.hpp"
+#include "composite-shape.hpp"
+
+namespace grechin
+{
+  const size_t INGEST_CHUNK = 1024;
+
+  // Every producer thread fills a private chunk and publishes it to a lock-free stack when it is full
+  // or flushed. commit() takes all published chunks with one exchange and appends them in bulk.
+  class IngestBuffer
+  {
+  private:
+    struct chunk_t;
+
+  public:
+    class Producer
+    {
+    public:
+      explicit Producer(IngestBuffer&);
+      Producer(const Producer&) = delete;
+      Producer(Producer&&) noexcept;
+      ~Producer();
+
+      Producer& operator=(const Producer&) = delete;
+
+      void push(const std::shared_ptr<Shape>&);
+      void push(std::shared_ptr<Shape>&&);
+      void flush();
+
+    private:
+      IngestBuffer* buffer_;
+      chunk_t* chunk_;
+    };
+
+    IngestBuffer();
+    IngestBuffer(const IngestBuffer&) = delete;
+    ~IngestBuffer();
+
+    IngestBuffer& operator=(const IngestBuffer&) = delete;
+
+    size_t getSize() const;
+    size_t commit(CompositeShape&);
+
+  private:
+    struct chunk_t
+    {
+      std::shared_ptr<Shape> shapes[INGEST_CHUNK];
+      size_t begin;
+      size_t end;
+      chunk_t* next;
+    };
+
+    std::atomic<chunk_t*> head_;
+    std::atomic<size_t> size_;
+
+    void publish(chunk_t*, chunk_t*, const size_t);
+  };
+}
+
+#endif
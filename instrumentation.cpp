@@ -0,0 +1,231 @@
+#include "instrumentation.hpp"
+
+#include <mutex>
+#include <ostream>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+  const char* const DEFAULT_SCOPE = "unscoped";
+
+  const char* const OPERATION_NAMES[grechin::instrumentation::OPERATION_COUNT] = {
+    "circle.getArea",
+    "circle.getFrameRect",
+    "circle.move",
+    "circle.scale",
+    "circle.rotate",
+    "rectangle.getArea",
+    "rectangle.getFrameRect",
+    "rectangle.move",
+    "rectangle.scale",
+    "rectangle.rotate",
+    "composite.getArea",
+    "composite.getFrameRect",
+    "composite.move",
+    "composite.scale",
+    "composite.rotate",
+    "composite.add",
+    "composite.remove",
+    "composite.flush",
+    "composite.reallocate"
+  };
+
+  struct thread_counters_t;
+
+  struct registry_t
+  {
+    std::mutex mutex;
+    std::vector<thread_counters_t*> threads;
+    grechin::instrumentation::Snapshot retired;
+  };
+
+  registry_t& getRegistry()
+  {
+    static registry_t* registry = new registry_t();
+    return *registry;
+  }
+
+  void merge(grechin::instrumentation::CounterTable& table, const grechin::instrumentation::CounterTable& other)
+  {
+    for (size_t i = 0; i < grechin::instrumentation::OPERATION_COUNT; i++)
+    {
+      table[i].calls += other[i].calls;
+      table[i].children += other[i].children;
+      table[i].allocations += other[i].allocations;
+      table[i].bytes += other[i].bytes;
+      table[i].nanoseconds += other[i].nanoseconds;
+    }
+  }
+
+  struct thread_counters_t
+  {
+    std::mutex mutex;
+    std::unordered_map<std::string, grechin::instrumentation::CounterTable> scopes;
+
+    thread_counters_t()
+    {
+      registry_t& registry = getRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.threads.push_back(this);
+    }
+
+    ~thread_counters_t()
+    {
+      registry_t& registry = getRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      for (const auto& scopeTable : scopes)
+      {
+        merge(registry.retired[scopeTable.first], scopeTable.second);
+      }
+      registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+    }
+  };
+
+  thread_local const char* currentScope = DEFAULT_SCOPE;
+  thread_local grechin::instrumentation::CounterTable* currentTable = nullptr;
+  thread_local grechin::instrumentation::Call* currentCall = nullptr;
+
+  void record(const grechin::instrumentation::Operation operation, const grechin::instrumentation::counters_t& counters)
+  {
+    thread_local thread_counters_t local;
+    std::lock_guard<std::mutex> lock(local.mutex);
+    if (currentTable == nullptr)
+    {
+      // The name is copied here, so a scope may be named by a buffer that dies with it
+      currentTable = &local.scopes.try_emplace(currentScope).first->second;
+    }
+    grechin::instrumentation::counters_t& total = (*currentTable)[static_cast<size_t>(operation)];
+    total.calls += counters.calls;
+    total.children += counters.children;
+    total.allocations += counters.allocations;
+    total.bytes += counters.bytes;
+    total.nanoseconds += counters.nanoseconds;
+  }
+
+  void writeString(std::ostream& out, const std::string& value)
+  {
+    out << '"';
+    for (const char symbol : value)
+    {
+      if (symbol == '"' || symbol == '\\')
+      {
+        out << '\\';
+      }
+      out << symbol;
+    }
+    out << '"';
+  }
+}
+
+const char* grechin::instrumentation::getOperationName(const Operation operation)
+{
+  return OPERATION_NAMES[static_cast<size_t>(operation)];
+}
+
+grechin::instrumentation::Snapshot grechin::instrumentation::getSnapshot()
+{
+  registry_t& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  Snapshot snapshot = registry.retired;
+  for (thread_counters_t* local : registry.threads)
+  {
+    std::lock_guard<std::mutex> localLock(local->mutex);
+    for (const auto& scopeTable : local->scopes)
+    {
+      merge(snapshot[scopeTable.first], scopeTable.second);
+    }
+  }
+  return snapshot;
+}
+
+void grechin::instrumentation::reset()
+{
+  registry_t& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.retired.clear();
+  for (thread_counters_t* local : registry.threads)
+  {
+    std::lock_guard<std::mutex> localLock(local->mutex);
+    for (auto& scopeTable : local->scopes)
+    {
+      scopeTable.second = CounterTable{};
+    }
+  }
+}
+
+void grechin::instrumentation::writeJson(std::ostream& out, const Snapshot& snapshot)
+{
+  out << '{';
+  bool firstScope = true;
+  for (const auto& scopeTable : snapshot)
+  {
+    out << (firstScope ? "" : ",");
+    firstScope = false;
+    writeString(out, scopeTable.first);
+    out << ":{";
+    bool firstOperation = true;
+    for (size_t i = 0; i < OPERATION_COUNT; i++)
+    {
+      const counters_t& counters = scopeTable.second[i];
+      if (counters.calls == 0)
+      {
+        continue;
+      }
+      out << (firstOperation ? "" : ",") << '"' << OPERATION_NAMES[i] << "\":{\"calls\":" << counters.calls
+          << ",\"children\":" << counters.children << ",\"allocations\":" << counters.allocations
+          << ",\"bytes\":" << counters.bytes << ",\"nanoseconds\":" << counters.nanoseconds << '}';
+      firstOperation = false;
+    }
+    out << '}';
+  }
+  out << '}';
+}
+
+void grechin::instrumentation::addChildren(const size_t count)
+{
+  if (currentCall != nullptr)
+  {
+    currentCall->counters_.children += count;
+  }
+}
+
+void grechin::instrumentation::addAllocation(const size_t bytes)
+{
+  if (currentCall != nullptr)
+  {
+    currentCall->counters_.allocations++;
+    currentCall->counters_.bytes += bytes;
+  }
+}
+
+grechin::instrumentation::Call::Call(const Operation operation) :
+  operation_(operation),
+  counters_{ 1, 0, 0, 0, 0 },
+  parent_(currentCall),
+  start_(std::chrono::steady_clock::now())
+{
+  currentCall = this;
+}
+
+grechin::instrumentation::Call::~Call()
+{
+  const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start_;
+  counters_.nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  currentCall = parent_;
+  record(operation_, counters_);
+}
+
+grechin::instrumentation::Scope::Scope(const char* name) :
+  parent_(currentScope)
+{
+  currentScope = name;
+  currentTable = nullptr;
+}
+
+grechin::instrumentation::Scope::~Scope()
+{
+  currentScope = parent_;
+  currentTable = nullptr;
+}
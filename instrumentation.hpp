@@ -0,0 +1,109 @@
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <string>
+
+#ifdef GRECHIN_INSTRUMENT
+#define GRECHIN_INSTRUMENT_CALL(operation) \
+  grechin::instrumentation::Call instrumentedCall_(grechin::instrumentation::Operation::operation)
+#define GRECHIN_INSTRUMENT_CHILDREN(count) grechin::instrumentation::addChildren(count)
+#define GRECHIN_INSTRUMENT_ALLOCATION(bytes) grechin::instrumentation::addAllocation(bytes)
+#define GRECHIN_INSTRUMENT_SCOPE(name) grechin::instrumentation::Scope instrumentedScope_(name)
+#else
+#define GRECHIN_INSTRUMENT_CALL(operation) static_cast<void>(0)
+#define GRECHIN_INSTRUMENT_CHILDREN(count) static_cast<void>(0)
+#define GRECHIN_INSTRUMENT_ALLOCATION(bytes) static_cast<void>(0)
+#define GRECHIN_INSTRUMENT_SCOPE(name) static_cast<void>(0)
+#endif
+
+namespace grechin
+{
+  namespace instrumentation
+  {
+    enum class Operation
+    {
+      circleGetArea,
+      circleGetFrameRect,
+      circleMove,
+      circleScale,
+      circleRotate,
+      rectangleGetArea,
+      rectangleGetFrameRect,
+      rectangleMove,
+      rectangleScale,
+      rectangleRotate,
+      compositeGetArea,
+      compositeGetFrameRect,
+      compositeMove,
+      compositeScale,
+      compositeRotate,
+      compositeAdd,
+      compositeRemove,
+      compositeFlush,
+      compositeReallocate
+    };
+
+    const size_t OPERATION_COUNT = static_cast<size_t>(Operation::compositeReallocate) + 1;
+
+    struct counters_t
+    {
+      uint64_t calls;
+      uint64_t children;
+      uint64_t allocations;
+      uint64_t bytes;
+      uint64_t nanoseconds;
+    };
+
+    typedef std::array<counters_t, OPERATION_COUNT> CounterTable;
+    typedef std::map<std::string, CounterTable> Snapshot;
+
+    const char* getOperationName(const Operation);
+    Snapshot getSnapshot();
+    void reset();
+    void writeJson(std::ostream&, const Snapshot&);
+
+    void addChildren(const size_t);
+    void addAllocation(const size_t);
+
+    class Call
+    {
+    public:
+      explicit Call(const Operation);
+      Call(const Call&) = delete;
+      ~Call();
+
+      Call& operator=(const Call&) = delete;
+
+    private:
+      Operation operation_;
+      counters_t counters_;
+      Call* parent_;
+      std::chrono::steady_clock::time_point start_;
+
+      friend void addChildren(const size_t);
+      friend void addAllocation(const size_t);
+    };
+
+    // The name must outlive the scope; it is copied on the first recorded call
+    class Scope
+    {
+    public:
+      explicit Scope(const char*);
+      Scope(const Scope&) = delete;
+      ~Scope();
+
+      Scope& operator=(const Scope&) = delete;
+
+    private:
+      const char* parent_;
+    };
+  }
+}
+
+#endif
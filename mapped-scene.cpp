@@ -0,0 +1,357 @@
+#include "mapped-scene.hpp"
+
+#define _USE_MATH_DEFINES
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace
+{
+  bool isLittleEndian()
+  {
+    const uint16_t value = 1;
+    unsigned char byte = 0;
+    std::memcpy(&byte, &value, 1);
+    return byte == 1;
+  }
+
+  void addWords(uint64_t& words, const uint64_t count, const uint64_t columns)
+  {
+    const uint64_t limit = (std::numeric_limits<uint64_t>::max() / 8 - words) / columns;
+    if (count > limit)
+    {
+      throw std::invalid_argument("Invalid shape data size");
+    }
+    words += count * columns;
+  }
+}
+
+grechin::MappedScene::MappedScene(const std::string& path) :
+  data_(nullptr),
+  size_(0),
+  header_{},
+  circleRadius_(nullptr),
+  circleX_(nullptr),
+  circleY_(nullptr),
+  rectWidth_(nullptr),
+  rectHeight_(nullptr),
+  rectX_(nullptr),
+  rectY_(nullptr),
+  rectAngle_(nullptr),
+  offsets_(nullptr),
+  references_(nullptr)
+{
+  if (!isLittleEndian())
+  {
+    throw std::logic_error("MappedScene requires a little-endian host");
+  }
+
+  const int file = open(path.c_str(), O_RDONLY);
+  if (file == -1)
+  {
+    throw std::invalid_argument("Cannot open scene file");
+  }
+  struct stat status = {};
+  if (fstat(file, &status) == -1 || static_cast<uint64_t>(status.st_size) < SERIALIZATION_HEADER_SIZE)
+  {
+    close(file);
+    throw std::invalid_argument("Unexpected end of shape data");
+  }
+  size_ = status.st_size;
+  void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0);
+  close(file);
+  if (data == MAP_FAILED)
+  {
+    throw std::invalid_argument("Cannot map scene file");
+  }
+  data_ = static_cast<const char*>(data);
+
+  try
+  {
+    header_ = readHeader(data_);
+    uint64_t words = 0;
+    addWords(words, header_.circleCount, 3);
+    addWords(words, header_.rectangleCount, 5);
+    addWords(words, header_.compositeCount + 1, 1);
+    addWords(words, header_.referenceCount, 1);
+    if (words > (size_ - SERIALIZATION_HEADER_SIZE) / 8)
+    {
+      throw std::invalid_argument("Unexpected end of shape data");
+    }
+    checkReference(header_.root);
+  }
+  catch (...)
+  {
+    release();
+    throw;
+  }
+
+  const double* column = reinterpret_cast<const double*>(data_ + SERIALIZATION_HEADER_SIZE);
+  circleRadius_ = column;
+  circleX_ = circleRadius_ + header_.circleCount;
+  circleY_ = circleX_ + header_.circleCount;
+  rectWidth_ = circleY_ + header_.circleCount;
+  rectHeight_ = rectWidth_ + header_.rectangleCount;
+  rectX_ = rectHeight_ + header_.rectangleCount;
+  rectY_ = rectX_ + header_.rectangleCount;
+  rectAngle_ = rectY_ + header_.rectangleCount;
+  offsets_ = reinterpret_cast<const uint64_t*>(rectAngle_ + header_.rectangleCount);
+  references_ = offsets_ + header_.compositeCount + 1;
+}
+
+grechin::MappedScene::MappedScene(MappedScene&& scene) noexcept :
+  data_(scene.data_),
+  size_(scene.size_),
+  header_(scene.header_),
+  circleRadius_(scene.circleRadius_),
+  circleX_(scene.circleX_),
+  circleY_(scene.circleY_),
+  rectWidth_(scene.rectWidth_),
+  rectHeight_(scene.rectHeight_),
+  rectX_(scene.rectX_),
+  rectY_(scene.rectY_),
+  rectAngle_(scene.rectAngle_),
+  offsets_(scene.offsets_),
+  references_(scene.references_),
+  compositeArea_(std::move(scene.compositeArea_)),
+  compositeFrame_(std::move(scene.compositeFrame_))
+{
+  scene.data_ = nullptr;
+  scene.size_ = 0;
+}
+
+grechin::MappedScene::~MappedScene()
+{
+  release();
+}
+
+grechin::MappedScene& grechin::MappedScene::operator=(MappedScene&& scene) noexcept
+{
+  if (this != &scene)
+  {
+    release();
+    data_ = scene.data_;
+    size_ = scene.size_;
+    header_ = scene.header_;
+    circleRadius_ = scene.circleRadius_;
+    circleX_ = scene.circleX_;
+    circleY_ = scene.circleY_;
+    rectWidth_ = scene.rectWidth_;
+    rectHeight_ = scene.rectHeight_;
+    rectX_ = scene.rectX_;
+    rectY_ = scene.rectY_;
+    rectAngle_ = scene.rectAngle_;
+    offsets_ = scene.offsets_;
+    references_ = scene.references_;
+    compositeArea_ = std::move(scene.compositeArea_);
+    compositeFrame_ = std::move(scene.compositeFrame_);
+    scene.data_ = nullptr;
+    scene.size_ = 0;
+  }
+  return *this;
+}
+
+size_t grechin::MappedScene::getCircleCount() const
+{
+  return header_.circleCount;
+}
+
+size_t grechin::MappedScene::getRectangleCount() const
+{
+  return header_.rectangleCount;
+}
+
+size_t grechin::MappedScene::getCompositeCount() const
+{
+  return header_.compositeCount;
+}
+
+uint64_t grechin::MappedScene::getRoot() const
+{
+  return header_.root;
+}
+
+size_t grechin::MappedScene::getChildCount(const uint64_t reference) const
+{
+  checkReference(reference);
+  if (getReferenceType(reference) != ShapeType::composite)
+  {
+    return 0;
+  }
+  const uint64_t index = getReferenceIndex(reference);
+  if (offsets_[index] > offsets_[index + 1] || offsets_[index + 1] > header_.referenceCount)
+  {
+    throw std::invalid_argument("Invalid composite offsets");
+  }
+  return offsets_[index + 1] - offsets_[index];
+}
+
+uint64_t grechin::MappedScene::getChild(const uint64_t reference, const size_t number) const
+{
+  if (number >= getChildCount(reference))
+  {
+    throw std::out_of_range("Out of range");
+  }
+  return references_[offsets_[getReferenceIndex(reference)] + number];
+}
+
+double grechin::MappedScene::getArea() const
+{
+  return getArea(header_.root);
+}
+
+grechin::rectangle_t grechin::MappedScene::getFrameRect() const
+{
+  return getFrameRect(header_.root);
+}
+
+double grechin::MappedScene::getArea(const uint64_t reference) const
+{
+  checkReference(reference);
+  if (getReferenceType(reference) != ShapeType::composite)
+  {
+    return getLeafArea(reference);
+  }
+  computeAggregates();
+  return compositeArea_[getReferenceIndex(reference)];
+}
+
+grechin::rectangle_t grechin::MappedScene::getFrameRect(const uint64_t reference) const
+{
+  checkReference(reference);
+  if (getReferenceType(reference) != ShapeType::composite)
+  {
+    return getLeafFrameRect(reference);
+  }
+  computeAggregates();
+  return compositeFrame_[getReferenceIndex(reference)];
+}
+
+void grechin::MappedScene::checkReference(const uint64_t reference) const
+{
+  const uint64_t index = getReferenceIndex(reference);
+  uint64_t count = 0;
+  switch (getReferenceType(reference))
+  {
+  case ShapeType::circle:
+    count = header_.circleCount;
+    break;
+  case ShapeType::rectangle:
+    count = header_.rectangleCount;
+    break;
+  case ShapeType::composite:
+    count = header_.compositeCount;
+    break;
+  }
+  if (index >= count)
+  {
+    throw std::out_of_range("Invalid shape reference");
+  }
+}
+
+double grechin::MappedScene::getLeafArea(const uint64_t reference) const
+{
+  const uint64_t index = getReferenceIndex(reference);
+  if (getReferenceType(reference) == ShapeType::circle)
+  {
+    return M_PI * circleRadius_[index] * circleRadius_[index];
+  }
+  return rectWidth_[index] * rectHeight_[index];
+}
+
+grechin::rectangle_t grechin::MappedScene::getLeafFrameRect(const uint64_t reference) const
+{
+  const uint64_t index = getReferenceIndex(reference);
+  if (getReferenceType(reference) == ShapeType::circle)
+  {
+    return rectangle_t{ 2 * circleRadius_[index], 2 * circleRadius_[index], { circleX_[index], circleY_[index] } };
+  }
+  const rotation_t rotation = addition::getRotation(rectAngle_[index]);
+  const double cosAngle = fabs(rotation.cos);
+  const double sinAngle = fabs(rotation.sin);
+  const double width = rectWidth_[index] * cosAngle + rectHeight_[index] * sinAngle;
+  const double height = rectWidth_[index] * sinAngle + rectHeight_[index] * cosAngle;
+  return rectangle_t{ width, height, { rectX_[index], rectY_[index] } };
+}
+
+void grechin::MappedScene::computeAggregates() const
+{
+  if (compositeArea_.size() == header_.compositeCount)
+  {
+    return;
+  }
+
+  std::vector<double> areas(header_.compositeCount);
+  std::vector<rectangle_t> frames(header_.compositeCount);
+  for (uint64_t i = 0; i < header_.compositeCount; i++)
+  {
+    if (offsets_[i] > offsets_[i + 1] || offsets_[i + 1] > header_.referenceCount)
+    {
+      throw std::invalid_argument("Invalid composite offsets");
+    }
+    double sum = 0;
+    double error = 0;
+    double xMin = std::numeric_limits<double>::infinity();
+    double yMin = xMin;
+    double xMax = -xMin;
+    double yMax = -xMin;
+    for (uint64_t j = offsets_[i]; j < offsets_[i + 1]; j++)
+    {
+      const uint64_t reference = references_[j];
+      checkReference(reference);
+      double area = 0;
+      rectangle_t frame = {};
+      if (getReferenceType(reference) == ShapeType::composite)
+      {
+        const uint64_t index = getReferenceIndex(reference);
+        if (index >= i)
+        {
+          throw std::invalid_argument("Invalid shape reference");
+        }
+        area = areas[index];
+        frame = frames[index];
+      }
+      else
+      {
+        area = getLeafArea(reference);
+        frame = getLeafFrameRect(reference);
+      }
+      const double result = sum + area;
+      error += (fabs(sum) >= fabs(area)) ? (sum - result) + area : (area - result) + sum;
+      sum = result;
+      xMin = std::min(xMin, frame.pos.x - frame.width / 2);
+      yMin = std::min(yMin, frame.pos.y - frame.height / 2);
+      xMax = std::max(xMax, frame.pos.x + frame.width / 2);
+      yMax = std::max(yMax, frame.pos.y + frame.height / 2);
+    }
+    areas[i] = sum + error;
+    if (offsets_[i] == offsets_[i + 1])
+    {
+      frames[i] = rectangle_t{ 0, 0, { 0, 0 } };
+    }
+    else
+    {
+      frames[i] = rectangle_t{ xMax - xMin, yMax - yMin, { (xMax + xMin) / 2, (yMax + yMin) / 2 } };
+    }
+  }
+  compositeArea_ = std::move(areas);
+  compositeFrame_ = std::move(frames);
+}
+
+void grechin::MappedScene::release()
+{
+  if (data_ != nullptr)
+  {
+    munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+  }
+}
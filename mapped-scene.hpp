@@ -0,0 +1,61 @@
+#ifndef MAPPED_SCENE_HPP
+#define MAPPED_SCENE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "base-types.hpp"
+#include "serialization.hpp"
+
+namespace grechin
+{
+  class MappedScene
+  {
+  public:
+    explicit MappedScene(const std::string&);
+    MappedScene(const MappedScene&) = delete;
+    MappedScene(MappedScene&&) noexcept;
+    ~MappedScene();
+
+    MappedScene& operator=(const MappedScene&) = delete;
+    MappedScene& operator=(MappedScene&&) noexcept;
+
+    size_t getCircleCount() const;
+    size_t getRectangleCount() const;
+    size_t getCompositeCount() const;
+    uint64_t getRoot() const;
+    size_t getChildCount(const uint64_t) const;
+    uint64_t getChild(const uint64_t, const size_t) const;
+
+    double getArea() const;
+    rectangle_t getFrameRect() const;
+    double getArea(const uint64_t) const;
+    rectangle_t getFrameRect(const uint64_t) const;
+
+  private:
+    const char* data_;
+    size_t size_;
+    serialization_header_t header_;
+    const double* circleRadius_;
+    const double* circleX_;
+    const double* circleY_;
+    const double* rectWidth_;
+    const double* rectHeight_;
+    const double* rectX_;
+    const double* rectY_;
+    const double* rectAngle_;
+    const uint64_t* offsets_;
+    const uint64_t* references_;
+    mutable std::vector<double> compositeArea_;
+    mutable std::vector<rectangle_t> compositeFrame_;
+
+    void checkReference(const uint64_t) const;
+    double getLeafArea(const uint64_t) const;
+    rectangle_t getLeafFrameRect(const uint64_t) const;
+    void computeAggregates() const;
+    void release();
+  };
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include "narrow-phase.hpp"
+
+#include <cmath>
+#include <typeinfo>
+#include <stdexcept>
+#include <algorithm>
+#include "shape.hpp"
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "composite-shape.hpp"
+
+namespace
+{
+  using grechin::collider_t;
+
+  bool hitCircles(const double dx, const double dy, const double firRadius, const double secRadius)
+  {
+    const double radius = firRadius + secRadius;
+    return dx * dx + dy * dy < radius * radius;
+  }
+
+  bool hitMixed(const double dx, const double dy, const double width, const double height, const double cosAngle,
+      const double sinAngle, const double radius)
+  {
+    const double x = std::max(fabs(dx * cosAngle + dy * sinAngle) - width, 0.0);
+    const double y = std::max(fabs(dy * cosAngle - dx * sinAngle) - height, 0.0);
+    return x * x + y * y < radius * radius;
+  }
+
+  bool hitBoxes(const double dx, const double dy, const double firWidth, const double firHeight,
+      const double firCos, const double firSin, const double secWidth, const double secHeight,
+      const double secCos, const double secSin)
+  {
+    const double cosAngle = fabs(firCos * secCos + firSin * secSin);
+    const double sinAngle = fabs(firSin * secCos - firCos * secSin);
+    const bool firX = fabs(dx * firCos + dy * firSin) < firWidth + secWidth * cosAngle + secHeight * sinAngle;
+    const bool firY = fabs(dy * firCos - dx * firSin) < firHeight + secWidth * sinAngle + secHeight * cosAngle;
+    const bool secX = fabs(dx * secCos + dy * secSin) < firWidth * cosAngle + firHeight * sinAngle + secWidth;
+    const bool secY = fabs(dy * secCos - dx * secSin) < firWidth * sinAngle + firHeight * cosAngle + secHeight;
+    return firX & firY & secX & secY;
+  }
+
+  bool hitColliders(const collider_t& fir, const collider_t& sec)
+  {
+    const double dx = sec.pos.x - fir.pos.x;
+    const double dy = sec.pos.y - fir.pos.y;
+    switch (fir.kind + 2 * sec.kind)
+    {
+    case collider_t::circle + 2 * collider_t::circle:
+      return hitCircles(dx, dy, fir.halfWidth, sec.halfWidth);
+    case collider_t::circle + 2 * collider_t::box:
+      return hitMixed(-dx, -dy, sec.halfWidth, sec.halfHeight, sec.rotation.cos, sec.rotation.sin, fir.halfWidth);
+    case collider_t::box + 2 * collider_t::circle:
+      return hitMixed(dx, dy, fir.halfWidth, fir.halfHeight, fir.rotation.cos, fir.rotation.sin, sec.halfWidth);
+    default:
+      return hitBoxes(dx, dy, fir.halfWidth, fir.halfHeight, fir.rotation.cos, fir.rotation.sin, sec.halfWidth,
+          sec.halfHeight, sec.rotation.cos, sec.rotation.sin);
+    }
+  }
+}
+
+grechin::collider_t grechin::getCollider(const Shape& shape)
+{
+  if (typeid(shape) == typeid(Circle))
+  {
+    const double radius = static_cast<const Circle&>(shape).getRadius();
+    return collider_t{ collider_t::circle, shape.getFrameRect().pos, radius, radius, { 1, 0 } };
+  }
+  if (typeid(shape) == typeid(Rectangle))
+  {
+    const Rectangle& rectangle = static_cast<const Rectangle&>(shape);
+    return collider_t{ collider_t::box, rectangle.getFrameRect().pos, rectangle.getWidth() / 2,
+        rectangle.getHeight() / 2, addition::getRotation(rectangle.getAngle()) };
+  }
+  // Other shapes are tested by their frame, which keeps the result conservative
+  const rectangle_t frame = shape.getFrameRect();
+  return collider_t{ collider_t::box, frame.pos, frame.width / 2, frame.height / 2, { 1, 0 } };
+}
+
+grechin::NarrowPhase::NarrowPhase()
+{}
+
+const std::vector<grechin::index_pair_t>& grechin::NarrowPhase::update(const std::vector<collider_t>& colliders,
+    const std::vector<index_pair_t>& pairs)
+{
+  for (const index_pair_t& pair : pairs)
+  {
+    if (pair.first >= colliders.size() || pair.second >= colliders.size())
+    {
+      throw std::out_of_range("Invalid pair index");
+    }
+  }
+
+  const collider_t* data = colliders.data();
+  pairs_.clear();
+  for (const index_pair_t& pair : pairs)
+  {
+    if (hitColliders(data[pair.first], data[pair.second]))
+    {
+      pairs_.push_back(pair);
+    }
+  }
+  return pairs_;
+}
+
+const std::vector<grechin::index_pair_t>& grechin::NarrowPhase::update(const CompositeShape& shape,
+    const std::vector<index_pair_t>& pairs)
+{
+  colliders_ = addition::getColliders(shape);
+  return update(colliders_, pairs);
+}
+
+const std::vector<grechin::index_pair_t>& grechin::NarrowPhase::getPairs() const
+{
+  return pairs_;
+}
+
+void grechin::NarrowPhase::reset()
+{
+  colliders_.clear();
+  pairs_.clear();
+}
+
+bool addition::isIntersected(const grechin::Shape& firShape, const grechin::Shape& secShape)
+{
+  if (!isOverlapped(firShape.getFrameRect(), secShape.getFrameRect()))
+  {
+    return false;
+  }
+  return isIntersected(grechin::getCollider(firShape), grechin::getCollider(secShape));
+}
+
+bool addition::isIntersected(const grechin::collider_t& fir, const grechin::collider_t& sec)
+{
+  return hitColliders(fir, sec);
+}
+
+std::vector<grechin::index_pair_t> addition::findIntersecting(const grechin::CompositeShape& shape)
+{
+  grechin::NarrowPhase narrow;
+  return narrow.update(getColliders(shape), findOverlapping(shape));
+}
+
+std::vector<grechin::collider_t> addition::getColliders(const grechin::CompositeShape& shape)
+{
+  std::vector<grechin::collider_t> colliders;
+  colliders.reserve(shape.getSize());
+  for (size_t i = 0; i < shape.getSize(); i++)
+  {
+    colliders.push_back(grechin::getCollider(*shape[i]));
+  }
+  return colliders;
+}
@@ -0,0 +1,56 @@
+#ifndef NARROW_PHASE_HPP
+#define NARROW_PHASE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "base-types.hpp"
+#include "broad-phase.hpp"
+
+namespace grechin
+{
+  class Shape;
+  class CompositeShape;
+
+  struct collider_t
+  {
+    enum Kind : uint8_t
+    {
+      circle,
+      box
+    };
+
+    Kind kind;
+    point_t pos;
+    double halfWidth;
+    double halfHeight;
+    rotation_t rotation;
+  };
+
+  collider_t getCollider(const Shape&);
+
+  class NarrowPhase
+  {
+  public:
+    NarrowPhase();
+
+    const std::vector<index_pair_t>& update(const std::vector<collider_t>&, const std::vector<index_pair_t>&);
+    const std::vector<index_pair_t>& update(const CompositeShape&, const std::vector<index_pair_t>&);
+    const std::vector<index_pair_t>& getPairs() const;
+    void reset();
+
+  private:
+    std::vector<collider_t> colliders_;
+    std::vector<index_pair_t> pairs_;
+  };
+}
+
+namespace addition
+{
+  bool isIntersected(const grechin::Shape&, const grechin::Shape&);
+  bool isIntersected(const grechin::collider_t&, const grechin::collider_t&);
+  std::vector<grechin::index_pair_t> findIntersecting(const grechin::CompositeShape&);
+  std::vector<grechin::collider_t> getColliders(const grechin::CompositeShape&);
+}
+
+#endif
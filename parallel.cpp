@@ -0,0 +1,24 @@
+#include "parallel.hpp"
+
+#include <thread>
+#include <algorithm>
+
+grechin::execution_policy_t grechin::parallel::getDefaultPolicy()
+{
+  return execution_policy_t{ false, true, 10000, 0 };
+}
+
+size_t grechin::parallel::getThreadCount(const execution_policy_t& policy, const size_t count)
+{
+  if (!policy.parallel || count < policy.threshold || count == 0)
+  {
+    return 1;
+  }
+
+  size_t threads = policy.threads;
+  if (threads == 0)
+  {
+    threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  }
+  return std::min(threads, count);
+}
@@ -0,0 +1,88 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <exception>
+
+namespace grechin
+{
+  struct execution_policy_t
+  {
+    bool parallel;
+    bool deterministic;
+    size_t threshold;
+    size_t threads;
+  };
+
+  namespace parallel
+  {
+    execution_policy_t getDefaultPolicy();
+    size_t getThreadCount(const execution_policy_t&, const size_t);
+
+    template <typename Function>
+    void forEachChunk(const size_t, const size_t, Function);
+  }
+}
+
+template <typename Function>
+void grechin::parallel::forEachChunk(const size_t count, const size_t chunks, Function function)
+{
+  if (chunks <= 1)
+  {
+    function(0, count, 0);
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  std::vector<std::exception_ptr> errors(chunks);
+  threads.reserve(chunks - 1);
+  for (size_t chunk = 1; chunk < chunks; chunk++)
+  {
+    try
+    {
+      threads.emplace_back([&, chunk]()
+      {
+        try
+        {
+          function(count * chunk / chunks, count * (chunk + 1) / chunks, chunk);
+        }
+        catch (...)
+        {
+          errors[chunk] = std::current_exception();
+        }
+      });
+    }
+    catch (...)
+    {
+      // Started workers still use this frame, and destroying a joinable thread terminates the process
+      for (std::thread& thread : threads)
+      {
+        thread.join();
+      }
+      throw;
+    }
+  }
+  try
+  {
+    function(0, count / chunks, 0);
+  }
+  catch (...)
+  {
+    errors[0] = std::current_exception();
+  }
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+  for (const std::exception_ptr& error : errors)
+  {
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+#endif
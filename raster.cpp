@@ -0,0 +1,321 @@
+#include "raster.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <atomic>
+#include <limits>
+#include <typeinfo>
+#include <stdexcept>
+#include <algorithm>
+#include "shape.hpp"
+#include "composite-shape.hpp"
+
+namespace
+{
+  using grechin::collider_t;
+
+  struct box_t
+  {
+    double xMin;
+    double yMin;
+    double xMax;
+    double yMax;
+  };
+
+  struct grid_t
+  {
+    double left;
+    double top;
+    double width;
+    double height;
+    size_t samples;
+  };
+
+  struct scratch_t
+  {
+    std::vector<uint8_t> mask;
+    std::vector<size_t> begins;
+    std::vector<size_t> ends;
+  };
+
+  box_t getBounds(const collider_t& shape)
+  {
+    const double width = shape.halfWidth * fabs(shape.rotation.cos) + shape.halfHeight * fabs(shape.rotation.sin);
+    const double height = shape.halfWidth * fabs(shape.rotation.sin) + shape.halfHeight * fabs(shape.rotation.cos);
+    return box_t{ shape.pos.x - width, shape.pos.y - height, shape.pos.x + width, shape.pos.y + height };
+  }
+
+  bool isInside(const collider_t& shape, const double x, const double y)
+  {
+    const double dx = x - shape.pos.x;
+    const double dy = y - shape.pos.y;
+    if (shape.kind == collider_t::circle)
+    {
+      return dx * dx + dy * dy <= shape.halfWidth * shape.halfWidth;
+    }
+    return fabs(dx * shape.rotation.cos + dy * shape.rotation.sin) <= shape.halfWidth
+        && fabs(dy * shape.rotation.cos - dx * shape.rotation.sin) <= shape.halfHeight;
+  }
+
+  bool isCovered(const collider_t& shape, const box_t& box)
+  {
+    return isInside(shape, box.xMin, box.yMin) && isInside(shape, box.xMax, box.yMin)
+        && isInside(shape, box.xMax, box.yMax) && isInside(shape, box.xMin, box.yMax);
+  }
+
+  bool clipSlab(const double slope, const double offset, const double half, double& left, double& right)
+  {
+    if (slope == 0)
+    {
+      return fabs(offset) <= half;
+    }
+    const double first = (-half - offset) / slope;
+    const double second = (half - offset) / slope;
+    left = std::max(left, std::min(first, second));
+    right = std::min(right, std::max(first, second));
+    return left <= right;
+  }
+
+  bool getSpan(const collider_t& shape, const double y, double& left, double& right)
+  {
+    const double dy = y - shape.pos.y;
+    if (shape.kind == collider_t::circle)
+    {
+      const double square = shape.halfWidth * shape.halfWidth - dy * dy;
+      if (square < 0)
+      {
+        return false;
+      }
+      const double half = std::sqrt(square);
+      left = shape.pos.x - half;
+      right = shape.pos.x + half;
+      return true;
+    }
+    double first = -std::numeric_limits<double>::infinity();
+    double last = std::numeric_limits<double>::infinity();
+    if (!clipSlab(shape.rotation.cos, dy * shape.rotation.sin, shape.halfWidth, first, last)
+        || !clipSlab(-shape.rotation.sin, dy * shape.rotation.cos, shape.halfHeight, first, last))
+    {
+      return false;
+    }
+    left = shape.pos.x + first;
+    right = shape.pos.x + last;
+    return true;
+  }
+
+  // Finds the samples with centers (k + 0.5) * step inside [from, to] among [offset, offset + count)
+  bool getSamples(const double from, const double to, const double step, const size_t offset, const size_t count,
+      size_t& first, size_t& last)
+  {
+    const double low = std::max(std::ceil(from / step - 0.5), static_cast<double>(offset));
+    const double high = std::min(std::floor(to / step - 0.5), static_cast<double>(offset + count) - 1);
+    if (!(low <= high))
+    {
+      return false;
+    }
+    first = static_cast<size_t>(low) - offset;
+    last = static_cast<size_t>(high) - offset;
+    return true;
+  }
+
+  bool getPixels(const double from, const double to, const double step, const size_t count, size_t& first,
+      size_t& last)
+  {
+    const double low = std::max(std::floor(from / step), 0.0);
+    const double high = std::min(std::floor(to / step), static_cast<double>(count) - 1);
+    if (!(low <= high))
+    {
+      return false;
+    }
+    first = static_cast<size_t>(low);
+    last = static_cast<size_t>(high);
+    return true;
+  }
+
+  unsigned getSampleSum(const uint8_t* source, const size_t stride, const size_t samples)
+  {
+    if (samples == 4)
+    {
+      // Mask bytes are 0 or 1, so a multiply gathers the four of them in the top byte
+      uint32_t sum = 0;
+      for (size_t i = 0; i < 4; i++)
+      {
+        uint32_t word = 0;
+        std::memcpy(&word, source + i * stride, sizeof(word));
+        sum += word;
+      }
+      return (sum * 0x01010101u) >> 24;
+    }
+    unsigned sum = 0;
+    for (size_t i = 0; i < samples; i++)
+    {
+      for (size_t j = 0; j < samples; j++)
+      {
+        sum += source[i * stride + j];
+      }
+    }
+    return sum;
+  }
+
+  void drawTile(const std::vector<collider_t>& shapes, const std::vector<size_t>& indices, const grid_t& grid,
+      const size_t column, const size_t row, const size_t columns, const size_t rows, scratch_t& scratch,
+      grechin::bitmap_t& bitmap)
+  {
+    if (indices.empty())
+    {
+      return;
+    }
+    const box_t tile = { grid.left + column * grid.width, grid.top - (row + rows) * grid.height,
+        grid.left + (column + columns) * grid.width, grid.top - row * grid.height };
+    for (const size_t index : indices)
+    {
+      if (isCovered(shapes[index], tile))
+      {
+        for (size_t y = 0; y < rows; y++)
+        {
+          std::memset(&bitmap.pixels[(row + y) * bitmap.width + column], 255, columns);
+        }
+        return;
+      }
+    }
+
+    // The mask keeps a fixed stride and is cleared only where spans were written
+    const size_t samples = grid.samples;
+    const size_t stride = grechin::RASTER_TILE * samples;
+    const double xStep = grid.width / samples;
+    const double yStep = grid.height / samples;
+    if (scratch.mask.empty())
+    {
+      scratch.mask.assign(stride * stride, 0);
+      scratch.begins.assign(grechin::RASTER_TILE, stride);
+      scratch.ends.assign(grechin::RASTER_TILE, 0);
+    }
+    for (const size_t index : indices)
+    {
+      const collider_t& shape = shapes[index];
+      const box_t bounds = getBounds(shape);
+      size_t first = 0;
+      size_t last = 0;
+      if (!getSamples(grid.top - bounds.yMax, grid.top - bounds.yMin, yStep, row * samples, rows * samples, first,
+          last))
+      {
+        continue;
+      }
+      for (size_t y = first; y <= last; y++)
+      {
+        double left = 0;
+        double right = 0;
+        size_t begin = 0;
+        size_t end = 0;
+        if (getSpan(shape, grid.top - (row * samples + y + 0.5) * yStep, left, right)
+            && getSamples(left - grid.left, right - grid.left, xStep, column * samples, columns * samples, begin, end))
+        {
+          std::memset(&scratch.mask[y * stride + begin], 1, end - begin + 1);
+          scratch.begins[y / samples] = std::min(scratch.begins[y / samples], begin);
+          scratch.ends[y / samples] = std::max(scratch.ends[y / samples], end + 1);
+        }
+      }
+    }
+
+    const unsigned total = samples * samples;
+    for (size_t y = 0; y < rows; y++)
+    {
+      if (scratch.begins[y] >= scratch.ends[y])
+      {
+        continue;
+      }
+      const size_t first = scratch.begins[y] / samples;
+      const size_t last = (scratch.ends[y] + samples - 1) / samples;
+      uint8_t* target = &bitmap.pixels[(row + y) * bitmap.width + column];
+      const uint8_t* source = &scratch.mask[y * samples * stride];
+      for (size_t x = first; x < last; x++)
+      {
+        const unsigned sum = getSampleSum(source + x * samples, stride, samples);
+        target[x] = static_cast<uint8_t>((sum * 255 + total / 2) / total);
+      }
+      for (size_t i = 0; i < samples; i++)
+      {
+        std::memset(&scratch.mask[(y * samples + i) * stride + first * samples], 0, (last - first) * samples);
+      }
+      scratch.begins[y] = stride;
+      scratch.ends[y] = 0;
+    }
+  }
+}
+
+grechin::bitmap_t grechin::rasterize(const Shape& shape, const rectangle_t& viewport, const size_t width,
+    const size_t height, const size_t samples, const execution_policy_t& policy)
+{
+  std::vector<collider_t> colliders;
+  if (typeid(shape) == typeid(CompositeShape))
+  {
+    static_cast<const CompositeShape&>(shape).forEachLeaf([&colliders](const Shape& leaf, const size_t)
+    {
+      colliders.push_back(getCollider(leaf));
+    });
+  }
+  else
+  {
+    colliders.push_back(getCollider(shape));
+  }
+  return rasterize(colliders, viewport, width, height, samples, policy);
+}
+
+grechin::bitmap_t grechin::rasterize(const std::vector<collider_t>& shapes, const rectangle_t& viewport,
+    const size_t width, const size_t height, const size_t samples, const execution_policy_t& policy)
+{
+  if (!(viewport.width > 0) || !(viewport.height > 0))
+  {
+    throw std::invalid_argument("Invalid viewport");
+  }
+  if (width == 0 || height == 0)
+  {
+    throw std::invalid_argument("Invalid resolution");
+  }
+  if (samples == 0)
+  {
+    throw std::invalid_argument("Invalid sample count");
+  }
+
+  bitmap_t bitmap = { width, height, std::vector<uint8_t>(width * height, 0) };
+  const grid_t grid = { viewport.pos.x - viewport.width / 2, viewport.pos.y + viewport.height / 2,
+      viewport.width / width, viewport.height / height, samples };
+  const size_t columns = (width + RASTER_TILE - 1) / RASTER_TILE;
+  const size_t rows = (height + RASTER_TILE - 1) / RASTER_TILE;
+  std::vector<std::vector<size_t>> tiles(columns * rows);
+  for (size_t i = 0; i < shapes.size(); i++)
+  {
+    const box_t bounds = getBounds(shapes[i]);
+    size_t xFirst = 0;
+    size_t xLast = 0;
+    size_t yFirst = 0;
+    size_t yLast = 0;
+    if (!getPixels(bounds.xMin - grid.left, bounds.xMax - grid.left, grid.width, width, xFirst, xLast)
+        || !getPixels(grid.top - bounds.yMax, grid.top - bounds.yMin, grid.height, height, yFirst, yLast))
+    {
+      continue;
+    }
+    for (size_t y = yFirst / RASTER_TILE; y <= yLast / RASTER_TILE; y++)
+    {
+      for (size_t x = xFirst / RASTER_TILE; x <= xLast / RASTER_TILE; x++)
+      {
+        tiles[y * columns + x].push_back(i);
+      }
+    }
+  }
+
+  const size_t threads = std::min(parallel::getThreadCount(policy, width * height), tiles.size());
+  std::atomic<size_t> next(0);
+  parallel::forEachChunk(threads, threads, [&](const size_t, const size_t, const size_t)
+  {
+    scratch_t scratch;
+    for (size_t i = next++; i < tiles.size(); i = next++)
+    {
+      const size_t column = (i % columns) * RASTER_TILE;
+      const size_t row = (i / columns) * RASTER_TILE;
+      drawTile(shapes, tiles[i], grid, column, row, std::min(RASTER_TILE, width - column),
+          std::min(RASTER_TILE, height - row), scratch, bitmap);
+    }
+  });
+  return bitmap;
+}
@@ -0,0 +1,33 @@
+#ifndef RASTER_HPP
+#define RASTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "base-types.hpp"
+#include "parallel.hpp"
+#include "narrow-phase.hpp"
+
+namespace grechin
+{
+  class Shape;
+
+  struct bitmap_t
+  {
+    size_t width;
+    size_t height;
+    std::vector<uint8_t> pixels;
+  };
+
+  const size_t RASTER_TILE = 64;
+  const size_t RASTER_SAMPLES = 4;
+
+  // Row 0 is the top of the viewport. With one sample per axis every pixel is 0 or 255,
+  // otherwise it holds the covered fraction of samples x samples subpixels.
+  bitmap_t rasterize(const Shape&, const rectangle_t&, const size_t, const size_t, const size_t,
+      const execution_policy_t&);
+  bitmap_t rasterize(const std::vector<collider_t>&, const rectangle_t&, const size_t, const size_t, const size_t,
+      const execution_policy_t&);
+}
+
+#endif
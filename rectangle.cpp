@@ -10,7 +10,9 @@ grechin::Rectangle::Rectangle(const double width, const double height, const poi
   width_(width),
   height_(height),
   center_(center),
-  angle_(angle)
+  angle_(angle),
+  rotation_(addition::getRotation(angle)),
+  revision_(0)
 {
   if (width_ <= 0 || height_ <= 0)
   {
@@ -18,42 +20,43 @@ grechin::Rectangle::Rectangle(const double width, const double height, const poi
   }
 }
 
-double grechin::Rectangle::getArea() const
+double grechin::Rectangle::getWidth() const
 {
-  return width_ * height_;
+  return width_;
 }
 
-grechin::rectangle_t grechin::Rectangle::getFrameRect() const
+double grechin::Rectangle::getHeight() const
 {
-  const double radAngle = angle_ * M_PI / 180;
-  const double width = width_ * fabs(cos(radAngle)) + height_ * fabs(sin(radAngle));
-  const double height = width_ * fabs(sin(radAngle)) + height_ * fabs(cos(radAngle));
-  return rectangle_t{ width, height, center_ };
+  return height_;
 }
 
-void grechin::Rectangle::move(const point_t& movePoint)
+double grechin::Rectangle::getAngle() const
 {
-  center_ = movePoint;
+  return angle_;
 }
 
-void grechin::Rectangle::move(const double xMove, const double yMove)
+void grechin::Rectangle::move(const point_t& movePoint)
 {
-  center_.x += xMove;
-  center_.y += yMove;
+  GRECHIN_INSTRUMENT_CALL(rectangleMove);
+  center_ = movePoint;
+  markEdited();
 }
 
 void grechin::Rectangle::scale(const double coefficient)
 {
+  GRECHIN_INSTRUMENT_CALL(rectangleScale);
   if (coefficient <= 0)
   {
     throw std::invalid_argument("Coefficient mus be > 0");
   }
   width_ *= coefficient;
   height_ *= coefficient;
+  markEdited();
 }
 
 void grechin::Rectangle::rotate(const double angle)
 {
+  GRECHIN_INSTRUMENT_CALL(rectangleRotate);
   angle_ += angle;
   if (angle_ < 0)
   {
@@ -63,6 +66,8 @@ void grechin::Rectangle::rotate(const double angle)
   {
     angle_ = fmod(angle_, 360);
   }
+  rotation_ = addition::getRotation(angle_);
+  markEdited();
 }
 
 void grechin::Rectangle::setWidth(const double width) 
@@ -72,6 +77,7 @@ void grechin::Rectangle::setWidth(const double width)
     throw std::invalid_argument("Width must be > 0");
   }
   width_ = width;
+  markEdited();
 }
 
 void grechin::Rectangle::setHeight(const double height) 
@@ -81,4 +87,5 @@ void grechin::Rectangle::setHeight(const double height)
     throw std::invalid_argument("Height must be > 0");
   }
   height_ = height;
+  markEdited();
 }
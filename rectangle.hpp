@@ -1,8 +1,11 @@
 #ifndef RECTANGLE_HPP
 #define RECTANGLE_HPP
 
+#include <cmath>
+#include <cstdint>
 #include "shape.hpp"
 #include "base-types.hpp"
+#include "instrumentation.hpp"
 
 namespace grechin
 {
@@ -11,6 +14,9 @@ namespace grechin
   public:
     Rectangle(const double, const double, const point_t&, const double = 0);
     double getArea() const override;
+    double getWidth() const;
+    double getHeight() const;
+    double getAngle() const;
     rectangle_t getFrameRect() const override;
     void move(const point_t&) override;
     void move(const double, const double) override;
@@ -18,13 +24,53 @@ namespace grechin
     void rotate(const double) override;
     void setWidth(const double);
     void setHeight(const double);
+    uint64_t getRevision() const;
 
   private:
     double width_;
     double height_;
     point_t center_;
     double angle_;
+    rotation_t rotation_;
+    uint64_t revision_;
+
+    void markEdited();
   };
 }
 
+inline double grechin::Rectangle::getArea() const
+{
+  GRECHIN_INSTRUMENT_CALL(rectangleGetArea);
+  return width_ * height_;
+}
+
+inline grechin::rectangle_t grechin::Rectangle::getFrameRect() const
+{
+  GRECHIN_INSTRUMENT_CALL(rectangleGetFrameRect);
+  const double cosAngle = fabs(rotation_.cos);
+  const double sinAngle = fabs(rotation_.sin);
+  const double width = width_ * cosAngle + height_ * sinAngle;
+  const double height = width_ * sinAngle + height_ * cosAngle;
+  return rectangle_t{ width, height, center_ };
+}
+
+inline void grechin::Rectangle::move(const double xMove, const double yMove)
+{
+  GRECHIN_INSTRUMENT_CALL(rectangleMove);
+  center_.x += xMove;
+  center_.y += yMove;
+  markEdited();
+}
+
+inline uint64_t grechin::Rectangle::getRevision() const
+{
+  return revision_;
+}
+
+inline void grechin::Rectangle::markEdited()
+{
+  revision_++;
+  addition::markEdited();
+}
+
 #endif 
@@ -0,0 +1,490 @@
+#include "serialization.hpp"
+
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <limits>
+#include <stdexcept>
+#include <typeinfo>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "composite-shape.hpp"
+#include "base-types.hpp"
+
+namespace
+{
+  const size_t COLUMN_CHUNK = 1 << 20;
+
+  bool isLittleEndian()
+  {
+    const uint16_t value = 1;
+    unsigned char byte = 0;
+    std::memcpy(&byte, &value, 1);
+    return byte == 1;
+  }
+
+  template <typename T>
+  void swapBytes(T* values, const size_t count)
+  {
+    if (isLittleEndian())
+    {
+      return;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+      unsigned char* bytes = reinterpret_cast<unsigned char*>(values + i);
+      std::reverse(bytes, bytes + sizeof(T));
+    }
+  }
+
+  class StreamOutput
+  {
+  public:
+    explicit StreamOutput(std::ostream& stream) :
+      stream_(stream)
+    {}
+
+    void write(const void* data, const size_t size)
+    {
+      stream_.write(static_cast<const char*>(data), size);
+      if (!stream_)
+      {
+        throw std::invalid_argument("Failed to write shape data");
+      }
+    }
+
+  private:
+    std::ostream& stream_;
+  };
+
+  class BufferOutput
+  {
+  public:
+    explicit BufferOutput(std::vector<char>& buffer) :
+      buffer_(buffer)
+    {}
+
+    void write(const void* data, const size_t size)
+    {
+      const char* bytes = static_cast<const char*>(data);
+      buffer_.insert(buffer_.end(), bytes, bytes + size);
+    }
+
+  private:
+    std::vector<char>& buffer_;
+  };
+
+  class StreamInput
+  {
+  public:
+    explicit StreamInput(std::istream& stream) :
+      stream_(stream)
+    {}
+
+    void read(void* data, const size_t size)
+    {
+      stream_.read(static_cast<char*>(data), size);
+      if (static_cast<size_t>(stream_.gcount()) != size)
+      {
+        throw std::invalid_argument("Unexpected end of shape data");
+      }
+    }
+
+    void require(const uint64_t)
+    {}
+
+  private:
+    std::istream& stream_;
+  };
+
+  class BufferInput
+  {
+  public:
+    BufferInput(const char* data, const size_t size) :
+      data_(data),
+      size_(size)
+    {}
+
+    void read(void* data, const size_t size)
+    {
+      require(size);
+      std::memcpy(data, data_, size);
+      data_ += size;
+      size_ -= size;
+    }
+
+    void require(const uint64_t size)
+    {
+      if (size > size_)
+      {
+        throw std::invalid_argument("Unexpected end of shape data");
+      }
+    }
+
+  private:
+    const char* data_;
+    size_t size_;
+  };
+
+  template <typename Output, typename T>
+  void writeColumn(Output& output, std::vector<T>& column)
+  {
+    swapBytes(column.data(), column.size());
+    output.write(column.data(), column.size() * sizeof(T));
+  }
+
+  template <typename Input, typename T>
+  void readColumn(Input& input, std::vector<T>& column, const uint64_t count)
+  {
+    if (count > std::numeric_limits<size_t>::max() / sizeof(T))
+    {
+      throw std::invalid_argument("Invalid shape data size");
+    }
+    input.require(count * sizeof(T));
+    column.clear();
+    for (size_t done = 0; done < count;)
+    {
+      const size_t size = std::min<size_t>(COLUMN_CHUNK, count - done);
+      column.resize(done + size);
+      input.read(column.data() + done, size * sizeof(T));
+      done += size;
+    }
+    swapBytes(column.data(), column.size());
+  }
+
+  class Writer
+  {
+  public:
+    uint64_t add(const grechin::Shape& root)
+    {
+      if (typeid(root) != typeid(grechin::CompositeShape))
+      {
+        return addLeaf(root, false);
+      }
+
+      struct frame_t
+      {
+        const grechin::CompositeShape* composite;
+        size_t next;
+        std::vector<uint64_t> references;
+      };
+      std::vector<frame_t> stack;
+      stack.push_back({ static_cast<const grechin::CompositeShape*>(&root), 0, {} });
+      visiting_.insert(&root);
+      uint64_t result = 0;
+      while (!stack.empty())
+      {
+        frame_t& frame = stack.back();
+        if (frame.next == frame.composite->getSize())
+        {
+          const uint64_t reference = grechin::makeReference(grechin::ShapeType::composite, offsets_.size() - 1);
+          references_.insert(references_.end(), frame.references.begin(), frame.references.end());
+          offsets_.push_back(references_.size());
+          known_[frame.composite] = reference;
+          visiting_.erase(frame.composite);
+          stack.pop_back();
+          if (stack.empty())
+          {
+            result = reference;
+          }
+          else
+          {
+            stack.back().references.push_back(reference);
+          }
+          continue;
+        }
+
+        const std::shared_ptr<grechin::Shape> child = (*frame.composite)[frame.next++];
+        const bool shared = child.use_count() > 2;
+        const bool composite = typeid(*child) == typeid(grechin::CompositeShape);
+        const std::unordered_map<const grechin::Shape*, uint64_t>::const_iterator found =
+            (shared || composite) ? known_.find(child.get()) : known_.end();
+        if (found != known_.end())
+        {
+          frame.references.push_back(found->second);
+        }
+        else if (composite)
+        {
+          if (!visiting_.insert(child.get()).second)
+          {
+            throw std::logic_error("CompositeShape must not contain itself");
+          }
+          stack.push_back({ static_cast<const grechin::CompositeShape*>(child.get()), 0, {} });
+        }
+        else
+        {
+          frame.references.push_back(addLeaf(*child, shared));
+        }
+      }
+      return result;
+    }
+
+    template <typename Output>
+    void write(Output& output, const uint64_t root)
+    {
+      grechin::serialization_header_t header = {};
+      std::memcpy(header.magic, grechin::SERIALIZATION_MAGIC, sizeof(header.magic));
+      header.version = grechin::SERIALIZATION_VERSION;
+      header.circleCount = circleRadius_.size();
+      header.rectangleCount = rectWidth_.size();
+      header.compositeCount = offsets_.size() - 1;
+      header.referenceCount = references_.size();
+      header.root = root;
+
+      char bytes[grechin::SERIALIZATION_HEADER_SIZE];
+      grechin::writeHeader(bytes, header);
+      output.write(bytes, sizeof(bytes));
+
+      writeColumn(output, circleRadius_);
+      writeColumn(output, circleX_);
+      writeColumn(output, circleY_);
+      writeColumn(output, rectWidth_);
+      writeColumn(output, rectHeight_);
+      writeColumn(output, rectX_);
+      writeColumn(output, rectY_);
+      writeColumn(output, rectAngle_);
+      writeColumn(output, offsets_);
+      writeColumn(output, references_);
+    }
+
+  private:
+    std::vector<double> circleRadius_;
+    std::vector<double> circleX_;
+    std::vector<double> circleY_;
+    std::vector<double> rectWidth_;
+    std::vector<double> rectHeight_;
+    std::vector<double> rectX_;
+    std::vector<double> rectY_;
+    std::vector<double> rectAngle_;
+    std::vector<uint64_t> offsets_ = { 0 };
+    std::vector<uint64_t> references_;
+    std::unordered_map<const grechin::Shape*, uint64_t> known_;
+    std::unordered_set<const grechin::Shape*> visiting_;
+
+    uint64_t addLeaf(const grechin::Shape& shape, const bool shared)
+    {
+      uint64_t reference = 0;
+      const grechin::point_t center = shape.getFrameRect().pos;
+      if (typeid(shape) == typeid(grechin::Circle))
+      {
+        reference = grechin::makeReference(grechin::ShapeType::circle, circleRadius_.size());
+        circleRadius_.push_back(static_cast<const grechin::Circle&>(shape).getRadius());
+        circleX_.push_back(center.x);
+        circleY_.push_back(center.y);
+      }
+      else if (typeid(shape) == typeid(grechin::Rectangle))
+      {
+        const grechin::Rectangle& rectangle = static_cast<const grechin::Rectangle&>(shape);
+        reference = grechin::makeReference(grechin::ShapeType::rectangle, rectWidth_.size());
+        rectWidth_.push_back(rectangle.getWidth());
+        rectHeight_.push_back(rectangle.getHeight());
+        rectX_.push_back(center.x);
+        rectY_.push_back(center.y);
+        rectAngle_.push_back(rectangle.getAngle());
+      }
+      else
+      {
+        throw std::invalid_argument("Unsupported shape type");
+      }
+      if (shared)
+      {
+        known_[&shape] = reference;
+      }
+      return reference;
+    }
+  };
+
+  template <typename Output>
+  void serializeShape(Output& output, const grechin::Shape& shape)
+  {
+    Writer writer;
+    const uint64_t root = writer.add(shape);
+    writer.write(output, root);
+  }
+
+  template <typename Input>
+  std::shared_ptr<grechin::Shape> deserializeShape(Input& input)
+  {
+    char bytes[grechin::SERIALIZATION_HEADER_SIZE];
+    input.read(bytes, sizeof(bytes));
+    const grechin::serialization_header_t header = grechin::readHeader(bytes);
+    const uint64_t circleCount = header.circleCount;
+    const uint64_t rectangleCount = header.rectangleCount;
+    const uint64_t compositeCount = header.compositeCount;
+    const uint64_t referenceCount = header.referenceCount;
+    const uint64_t root = header.root;
+
+    std::vector<double> radius;
+    std::vector<double> x;
+    std::vector<double> y;
+    readColumn(input, radius, circleCount);
+    readColumn(input, x, circleCount);
+    readColumn(input, y, circleCount);
+    std::vector<std::shared_ptr<grechin::Shape>> circles(circleCount);
+    for (size_t i = 0; i < circleCount; i++)
+    {
+      circles[i] = std::make_shared<grechin::Circle>(radius[i], grechin::point_t{ x[i], y[i] });
+    }
+
+    std::vector<double> width;
+    std::vector<double> height;
+    std::vector<double> angle;
+    readColumn(input, width, rectangleCount);
+    readColumn(input, height, rectangleCount);
+    readColumn(input, x, rectangleCount);
+    readColumn(input, y, rectangleCount);
+    readColumn(input, angle, rectangleCount);
+    std::vector<std::shared_ptr<grechin::Shape>> rectangles(rectangleCount);
+    for (size_t i = 0; i < rectangleCount; i++)
+    {
+      rectangles[i] = std::make_shared<grechin::Rectangle>(width[i], height[i], grechin::point_t{ x[i], y[i] },
+          angle[i]);
+    }
+
+    std::vector<uint64_t> offsets;
+    std::vector<uint64_t> references;
+    readColumn(input, offsets, compositeCount + 1);
+    readColumn(input, references, referenceCount);
+    if (offsets.front() != 0 || offsets.back() != referenceCount)
+    {
+      throw std::invalid_argument("Invalid composite offsets");
+    }
+    for (size_t i = 0; i < compositeCount; i++)
+    {
+      if (offsets[i] > offsets[i + 1] || offsets[i + 1] > referenceCount)
+      {
+        throw std::invalid_argument("Invalid composite offsets");
+      }
+    }
+
+    std::vector<std::shared_ptr<grechin::Shape>> composites(compositeCount);
+    const auto resolve = [&](const uint64_t reference, const uint64_t limit)
+    {
+      const uint64_t index = grechin::getReferenceIndex(reference);
+      switch (grechin::getReferenceType(reference))
+      {
+      case grechin::ShapeType::circle:
+        if (index < circleCount)
+        {
+          return circles[index];
+        }
+        break;
+      case grechin::ShapeType::rectangle:
+        if (index < rectangleCount)
+        {
+          return rectangles[index];
+        }
+        break;
+      case grechin::ShapeType::composite:
+        if (index < limit)
+        {
+          return composites[index];
+        }
+        break;
+      }
+      throw std::invalid_argument("Invalid shape reference");
+    };
+
+    for (size_t i = 0; i < compositeCount; i++)
+    {
+      std::shared_ptr<grechin::CompositeShape> composite = std::make_shared<grechin::CompositeShape>();
+      composite->reserve(offsets[i + 1] - offsets[i]);
+      for (uint64_t j = offsets[i]; j < offsets[i + 1]; j++)
+      {
+        composite->add(resolve(references[j], i));
+      }
+      composites[i] = composite;
+    }
+    return resolve(root, compositeCount);
+  }
+}
+
+void grechin::serialize(std::ostream& stream, const Shape& shape)
+{
+  StreamOutput output(stream);
+  serializeShape(output, shape);
+}
+
+std::vector<char> grechin::serialize(const Shape& shape)
+{
+  std::vector<char> buffer;
+  BufferOutput output(buffer);
+  serializeShape(output, shape);
+  return buffer;
+}
+
+std::shared_ptr<grechin::Shape> grechin::deserialize(std::istream& stream)
+{
+  StreamInput input(stream);
+  return deserializeShape(input);
+}
+
+std::shared_ptr<grechin::Shape> grechin::deserialize(const char* data, const size_t size)
+{
+  BufferInput input(data, size);
+  return deserializeShape(input);
+}
+
+void grechin::writeHeader(char* bytes, const serialization_header_t& header)
+{
+  uint32_t version = header.version;
+  uint64_t counts[5] = { header.circleCount, header.rectangleCount, header.compositeCount, header.referenceCount,
+      header.root };
+  swapBytes(&version, 1);
+  swapBytes(counts, 5);
+  std::memcpy(bytes, header.magic, sizeof(header.magic));
+  std::memcpy(bytes + 4, &version, sizeof(version));
+  std::memcpy(bytes + 8, counts, sizeof(counts));
+}
+
+grechin::serialization_header_t grechin::readHeader(const char* bytes)
+{
+  serialization_header_t header = {};
+  if (std::memcmp(bytes, SERIALIZATION_MAGIC, sizeof(header.magic)) != 0)
+  {
+    throw std::invalid_argument("Invalid shape data signature");
+  }
+  std::memcpy(header.magic, bytes, sizeof(header.magic));
+  std::memcpy(&header.version, bytes + 4, sizeof(header.version));
+  swapBytes(&header.version, 1);
+  if (header.version == 0 || header.version > SERIALIZATION_VERSION)
+  {
+    throw std::invalid_argument("Unsupported shape data version");
+  }
+  uint64_t counts[5] = {};
+  std::memcpy(counts, bytes + 8, sizeof(counts));
+  swapBytes(counts, 5);
+  header.circleCount = counts[0];
+  header.rectangleCount = counts[1];
+  header.compositeCount = counts[2];
+  header.referenceCount = counts[3];
+  header.root = counts[4];
+  if (header.compositeCount == std::numeric_limits<uint64_t>::max())
+  {
+    throw std::invalid_argument("Invalid shape data size");
+  }
+  return header;
+}
+
+uint64_t grechin::makeReference(const ShapeType type, const uint64_t index)
+{
+  return (index << 2) | static_cast<uint64_t>(type);
+}
+
+grechin::ShapeType grechin::getReferenceType(const uint64_t reference)
+{
+  const uint64_t type = reference & 3;
+  if (type > static_cast<uint64_t>(ShapeType::composite))
+  {
+    throw std::invalid_argument("Invalid shape reference");
+  }
+  return static_cast<ShapeType>(type);
+}
+
+uint64_t grechin::getReferenceIndex(const uint64_t reference)
+{
+  return reference >> 2;
+}
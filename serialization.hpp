@@ -0,0 +1,48 @@
+#ifndef SERIALIZATION_HPP
+#define SERIALIZATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+namespace grechin
+{
+  class Shape;
+
+  enum class ShapeType : uint64_t
+  {
+    circle = 0,
+    rectangle = 1,
+    composite = 2
+  };
+
+  struct serialization_header_t
+  {
+    char magic[4];
+    uint32_t version;
+    uint64_t circleCount;
+    uint64_t rectangleCount;
+    uint64_t compositeCount;
+    uint64_t referenceCount;
+    uint64_t root;
+  };
+
+  const char SERIALIZATION_MAGIC[4] = { 'G', 'R', 'S', 'H' };
+  const uint32_t SERIALIZATION_VERSION = 1;
+  const size_t SERIALIZATION_HEADER_SIZE = 48;
+
+  void serialize(std::ostream&, const Shape&);
+  std::vector<char> serialize(const Shape&);
+  std::shared_ptr<Shape> deserialize(std::istream&);
+  std::shared_ptr<Shape> deserialize(const char*, const size_t);
+
+  void writeHeader(char*, const serialization_header_t&);
+  serialization_header_t readHeader(const char*);
+  uint64_t makeReference(const ShapeType, const uint64_t);
+  ShapeType getReferenceType(const uint64_t);
+  uint64_t getReferenceIndex(const uint64_t);
+}
+
+#endif
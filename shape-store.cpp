@@ -0,0 +1,236 @@
+#include "shape-store.hpp"
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "composite-shape.hpp"
+#include "frame-kernels.hpp"
+
+namespace
+{
+  double normalizeAngle(const double angle)
+  {
+    if (angle < 0)
+    {
+      return 360 + fmod(angle, 360);
+    }
+    return fmod(angle, 360);
+  }
+}
+
+grechin::ShapeStore::ShapeStore()
+{}
+
+grechin::ShapeStore::ShapeStore(const CompositeShape& shape)
+{
+  importShape(shape);
+}
+
+size_t grechin::ShapeStore::getCircleCount() const
+{
+  return circleRadius_.size();
+}
+
+size_t grechin::ShapeStore::getRectangleCount() const
+{
+  return rectWidth_.size();
+}
+
+size_t grechin::ShapeStore::getSize() const
+{
+  return circleRadius_.size() + rectWidth_.size();
+}
+
+void grechin::ShapeStore::addCircle(const double radius, const point_t& center)
+{
+  if (radius <= 0)
+  {
+    throw std::invalid_argument("Radius must be > 0");
+  }
+  circleRadius_.push_back(radius);
+  circleX_.push_back(center.x);
+  circleY_.push_back(center.y);
+}
+
+void grechin::ShapeStore::addRectangle(const double width, const double height, const point_t& center,
+    const double angle)
+{
+  if (width <= 0 || height <= 0)
+  {
+    throw std::invalid_argument("Width and height must be > 0");
+  }
+  rectWidth_.push_back(width);
+  rectHeight_.push_back(height);
+  rectX_.push_back(center.x);
+  rectY_.push_back(center.y);
+  rectAngle_.push_back(angle);
+  const rotation_t rotation = addition::getRotation(angle);
+  rectCos_.push_back(rotation.cos);
+  rectSin_.push_back(rotation.sin);
+}
+
+void grechin::ShapeStore::importShape(const Shape& shape)
+{
+  if (const Circle* circle = dynamic_cast<const Circle*>(&shape))
+  {
+    addCircle(circle->getRadius(), circle->getFrameRect().pos);
+  }
+  else if (const Rectangle* rectangle = dynamic_cast<const Rectangle*>(&shape))
+  {
+    addRectangle(rectangle->getWidth(), rectangle->getHeight(), rectangle->getFrameRect().pos,
+        rectangle->getAngle());
+  }
+  else if (const CompositeShape* composite = dynamic_cast<const CompositeShape*>(&shape))
+  {
+    for (size_t i = 0; i < composite->getSize(); i++)
+    {
+      importShape(*(*composite)[i]);
+    }
+  }
+  else
+  {
+    throw std::invalid_argument("Unsupported shape type");
+  }
+}
+
+grechin::CompositeShape grechin::ShapeStore::exportShapes() const
+{
+  CompositeShape composite;
+  composite.reserve(getSize());
+  for (size_t i = 0; i < circleRadius_.size(); i++)
+  {
+    composite.add(std::make_shared<Circle>(circleRadius_[i], point_t{ circleX_[i], circleY_[i] }));
+  }
+  for (size_t i = 0; i < rectWidth_.size(); i++)
+  {
+    composite.add(std::make_shared<Rectangle>(rectWidth_[i], rectHeight_[i], point_t{ rectX_[i], rectY_[i] },
+        rectAngle_[i]));
+  }
+  return composite;
+}
+
+void grechin::ShapeStore::reserve(const size_t circles, const size_t rectangles)
+{
+  circleRadius_.reserve(circles);
+  circleX_.reserve(circles);
+  circleY_.reserve(circles);
+  rectWidth_.reserve(rectangles);
+  rectHeight_.reserve(rectangles);
+  rectX_.reserve(rectangles);
+  rectY_.reserve(rectangles);
+  rectAngle_.reserve(rectangles);
+  rectCos_.reserve(rectangles);
+  rectSin_.reserve(rectangles);
+}
+
+void grechin::ShapeStore::clear()
+{
+  circleRadius_.clear();
+  circleX_.clear();
+  circleY_.clear();
+  rectWidth_.clear();
+  rectHeight_.clear();
+  rectX_.clear();
+  rectY_.clear();
+  rectAngle_.clear();
+  rectCos_.clear();
+  rectSin_.clear();
+}
+
+double grechin::ShapeStore::totalArea() const
+{
+  return kernels::circleAreaSum(circleRadius_.data(), circleRadius_.size())
+      + kernels::rectangleAreaSum(rectWidth_.data(), rectHeight_.data(), rectWidth_.size());
+}
+
+grechin::rectangle_t grechin::ShapeStore::frameRect() const
+{
+  if (getSize() == 0)
+  {
+    return { 0, 0, {0, 0} };
+  }
+
+  kernels::bounds_t bounds = kernels::getEmptyBounds();
+  kernels::circleBounds(circleRadius_.data(), circleX_.data(), circleY_.data(), circleRadius_.size(), bounds);
+  kernels::rectangleBounds(rectWidth_.data(), rectHeight_.data(), rectX_.data(), rectY_.data(), rectCos_.data(),
+      rectSin_.data(), rectWidth_.size(), bounds);
+
+  const double xMax = bounds.xMax;
+  const double yMax = bounds.yMax;
+  const double xMin = bounds.xMin;
+  const double yMin = bounds.yMin;
+  return rectangle_t{ xMax - xMin, yMax - yMin, { (xMax + xMin) / 2, (yMax + yMin) / 2 } };
+}
+
+void grechin::ShapeStore::translate(const double xMove, const double yMove)
+{
+  const size_t circles = circleRadius_.size();
+  for (size_t i = 0; i < circles; i++)
+  {
+    circleX_[i] += xMove;
+    circleY_[i] += yMove;
+  }
+
+  const size_t rectangles = rectWidth_.size();
+  for (size_t i = 0; i < rectangles; i++)
+  {
+    rectX_[i] += xMove;
+    rectY_[i] += yMove;
+  }
+}
+
+void grechin::ShapeStore::scaleAbout(const point_t& center, const double coefficient)
+{
+  if (coefficient <= 0)
+  {
+    throw std::invalid_argument("Coefficient must be > 0");
+  }
+
+  const size_t circles = circleRadius_.size();
+  for (size_t i = 0; i < circles; i++)
+  {
+    circleRadius_[i] *= coefficient;
+    circleX_[i] += (circleX_[i] - center.x) * (coefficient - 1);
+    circleY_[i] += (circleY_[i] - center.y) * (coefficient - 1);
+  }
+
+  const size_t rectangles = rectWidth_.size();
+  for (size_t i = 0; i < rectangles; i++)
+  {
+    rectWidth_[i] *= coefficient;
+    rectHeight_[i] *= coefficient;
+    rectX_[i] += (rectX_[i] - center.x) * (coefficient - 1);
+    rectY_[i] += (rectY_[i] - center.y) * (coefficient - 1);
+  }
+}
+
+void grechin::ShapeStore::rotateAbout(const point_t& center, const double angle)
+{
+  const rotation_t rotation = addition::getRotation(angle);
+  const double cosAngle = fabs(rotation.cos);
+  const double sinAngle = fabs(rotation.sin);
+
+  const size_t circles = circleRadius_.size();
+  for (size_t i = 0; i < circles; i++)
+  {
+    const double xTemp = circleX_[i] - center.x;
+    const double yTemp = circleY_[i] - center.y;
+    circleX_[i] = xTemp * cosAngle - yTemp * sinAngle + center.x;
+    circleY_[i] = xTemp * sinAngle + yTemp * cosAngle + center.y;
+  }
+
+  const size_t rectangles = rectWidth_.size();
+  for (size_t i = 0; i < rectangles; i++)
+  {
+    const double xTemp = rectX_[i] - center.x;
+    const double yTemp = rectY_[i] - center.y;
+    rectX_[i] = xTemp * cosAngle - yTemp * sinAngle + center.x;
+    rectY_[i] = xTemp * sinAngle + yTemp * cosAngle + center.y;
+    rectAngle_[i] = normalizeAngle(rectAngle_[i] + angle);
+    const rotation_t rectRotation = addition::getRotation(rectAngle_[i]);
+    rectCos_[i] = rectRotation.cos;
+    rectSin_[i] = rectRotation.sin;
+  }
+}
@@ -0,0 +1,51 @@
+#ifndef SHAPE_STORE_HPP
+#define SHAPE_STORE_HPP
+
+#include <cstddef>
+#include <vector>
+#include "base-types.hpp"
+
+namespace grechin
+{
+  class Shape;
+  class CompositeShape;
+
+  class ShapeStore
+  {
+  public:
+    ShapeStore();
+    explicit ShapeStore(const CompositeShape&);
+
+    size_t getCircleCount() const;
+    size_t getRectangleCount() const;
+    size_t getSize() const;
+
+    void addCircle(const double, const point_t&);
+    void addRectangle(const double, const double, const point_t&, const double = 0);
+    void importShape(const Shape&);
+    CompositeShape exportShapes() const;
+    void reserve(const size_t, const size_t);
+    void clear();
+
+    double totalArea() const;
+    rectangle_t frameRect() const;
+    void translate(const double, const double);
+    void scaleAbout(const point_t&, const double);
+    void rotateAbout(const point_t&, const double);
+
+  private:
+    std::vector<double> circleRadius_;
+    std::vector<double> circleX_;
+    std::vector<double> circleY_;
+
+    std::vector<double> rectWidth_;
+    std::vector<double> rectHeight_;
+    std::vector<double> rectX_;
+    std::vector<double> rectY_;
+    std::vector<double> rectAngle_;
+    std::vector<double> rectCos_;
+    std::vector<double> rectSin_;
+  };
+}
+
+#endif
@@ -0,0 +1,336 @@
+#include "spatial-grid.hpp"
+
+#include <cmath>
+#include <queue>
+#include <utility>
+#include <unordered_set>
+#include <algorithm>
+
+namespace
+{
+  const double MAX_CELLS_PER_SHAPE = 64;
+  const double MAX_CELL_INDEX = 1e15;
+
+  bool containsPoint(const grechin::rectangle_t& frame, const grechin::point_t& point)
+  {
+    return (std::fabs(point.x - frame.pos.x) <= frame.width / 2)
+        && (std::fabs(point.y - frame.pos.y) <= frame.height / 2);
+  }
+}
+
+grechin::SpatialGrid::SpatialGrid() :
+  cellSize_(0),
+  offset_{ 0, 0 },
+  extent_{ 0, 0, -1, -1 }
+{}
+
+size_t grechin::SpatialGrid::getSize() const
+{
+  return frames_.size();
+}
+
+double grechin::SpatialGrid::getCellSize() const
+{
+  return cellSize_;
+}
+
+void grechin::SpatialGrid::build(const std::vector<rectangle_t>& frames)
+{
+  clear();
+
+  double extent = 0;
+  for (const rectangle_t& frame : frames)
+  {
+    extent += std::max(frame.width, frame.height);
+  }
+  if (!frames.empty())
+  {
+    cellSize_ = extent / frames.size();
+  }
+  if (!(cellSize_ > 0) || !std::isfinite(cellSize_))
+  {
+    cellSize_ = 1;
+  }
+
+  frames_.reserve(frames.size());
+  for (size_t i = 0; i < frames.size(); i++)
+  {
+    insert(i, frames[i]);
+  }
+}
+
+void grechin::SpatialGrid::insert(const size_t id, const rectangle_t& frame)
+{
+  if (cellSize_ == 0)
+  {
+    cellSize_ = std::max(frame.width, frame.height);
+    if (!(cellSize_ > 0) || !std::isfinite(cellSize_))
+    {
+      cellSize_ = 1;
+    }
+  }
+  if (id >= frames_.size())
+  {
+    frames_.resize(id + 1, rectangle_t{ 0, 0, { 0, 0 } });
+  }
+
+  const rectangle_t local = { frame.width, frame.height, { frame.pos.x - offset_.x, frame.pos.y - offset_.y } };
+  frames_[id] = local;
+
+  const cell_range_t range = getCells(local);
+  if (getCellCount(range) > MAX_CELLS_PER_SHAPE)
+  {
+    oversized_.push_back(id);
+    return;
+  }
+
+  for (int64_t y = range.yMin; y <= range.yMax; y++)
+  {
+    for (int64_t x = range.xMin; x <= range.xMax; x++)
+    {
+      cells_[getKey(x, y)].push_back(id);
+    }
+  }
+
+  if (extent_.xMin > extent_.xMax)
+  {
+    extent_ = range;
+  }
+  else
+  {
+    extent_.xMin = std::min(extent_.xMin, range.xMin);
+    extent_.yMin = std::min(extent_.yMin, range.yMin);
+    extent_.xMax = std::max(extent_.xMax, range.xMax);
+    extent_.yMax = std::max(extent_.yMax, range.yMax);
+  }
+}
+
+void grechin::SpatialGrid::translate(const double xMove, const double yMove)
+{
+  offset_.x += xMove;
+  offset_.y += yMove;
+}
+
+void grechin::SpatialGrid::clear()
+{
+  cellSize_ = 0;
+  offset_ = { 0, 0 };
+  frames_.clear();
+  oversized_.clear();
+  cells_.clear();
+  extent_ = { 0, 0, -1, -1 };
+}
+
+std::vector<size_t> grechin::SpatialGrid::queryOverlapping(const rectangle_t& area) const
+{
+  std::vector<size_t> result;
+  if (frames_.empty())
+  {
+    return result;
+  }
+
+  const rectangle_t local = { area.width, area.height, { area.pos.x - offset_.x, area.pos.y - offset_.y } };
+  cell_range_t range = getCells(local);
+  range.xMin = std::max(range.xMin, extent_.xMin);
+  range.yMin = std::max(range.yMin, extent_.yMin);
+  range.xMax = std::min(range.xMax, extent_.xMax);
+  range.yMax = std::min(range.yMax, extent_.yMax);
+
+  std::vector<size_t> candidates(oversized_);
+  if (range.xMin <= range.xMax && range.yMin <= range.yMax && getCellCount(range) > frames_.size())
+  {
+    candidates.resize(frames_.size());
+    for (size_t i = 0; i < frames_.size(); i++)
+    {
+      candidates[i] = i;
+    }
+  }
+  else
+  {
+    for (int64_t y = range.yMin; y <= range.yMax; y++)
+    {
+      for (int64_t x = range.xMin; x <= range.xMax; x++)
+      {
+        const std::vector<size_t>* cell = findCell(x, y);
+        if (cell != nullptr)
+        {
+          candidates.insert(candidates.end(), cell->begin(), cell->end());
+        }
+      }
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+  for (const size_t id : candidates)
+  {
+    if (addition::isOverlapped(frames_[id], local))
+    {
+      result.push_back(id);
+    }
+  }
+  return result;
+}
+
+std::vector<size_t> grechin::SpatialGrid::queryPoint(const point_t& point) const
+{
+  std::vector<size_t> result;
+  if (frames_.empty())
+  {
+    return result;
+  }
+
+  const point_t local = { point.x - offset_.x, point.y - offset_.y };
+  for (const size_t id : oversized_)
+  {
+    if (containsPoint(frames_[id], local))
+    {
+      result.push_back(id);
+    }
+  }
+  const std::vector<size_t>* cell = findCell(getCell(local.x), getCell(local.y));
+  if (cell != nullptr)
+  {
+    for (const size_t id : *cell)
+    {
+      if (containsPoint(frames_[id], local))
+      {
+        result.push_back(id);
+      }
+    }
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+std::vector<size_t> grechin::SpatialGrid::nearest(const point_t& point, const size_t count) const
+{
+  typedef std::pair<double, size_t> Candidate;
+
+  std::vector<size_t> result;
+  if (count == 0 || frames_.empty())
+  {
+    return result;
+  }
+
+  std::priority_queue<Candidate> best;
+  std::unordered_set<size_t> visited;
+  const auto consider = [&](const size_t id)
+  {
+    if (!visited.insert(id).second)
+    {
+      return;
+    }
+    const Candidate candidate(getDistance(id, point), id);
+    if (best.size() < count)
+    {
+      best.push(candidate);
+    }
+    else if (candidate < best.top())
+    {
+      best.pop();
+      best.push(candidate);
+    }
+  };
+
+  for (const size_t id : oversized_)
+  {
+    consider(id);
+  }
+
+  if (extent_.xMin <= extent_.xMax)
+  {
+    const int64_t cx = getCell(point.x - offset_.x);
+    const int64_t cy = getCell(point.y - offset_.y);
+    const int64_t start = std::max({ extent_.xMin - cx, cx - extent_.xMax, extent_.yMin - cy, cy - extent_.yMax,
+        int64_t(0) });
+    const int64_t finish = std::max({ cx - extent_.xMin, extent_.xMax - cx, cy - extent_.yMin, extent_.yMax - cy });
+
+    for (int64_t ring = start; ring <= finish; ring++)
+    {
+      if (best.size() == count && best.top().first <= (ring - 1) * cellSize_)
+      {
+        break;
+      }
+
+      const int64_t xMin = std::max(cx - ring, extent_.xMin);
+      const int64_t xMax = std::min(cx + ring, extent_.xMax);
+      const int64_t yMin = std::max(cy - ring, extent_.yMin);
+      const int64_t yMax = std::min(cy + ring, extent_.yMax);
+      for (int64_t y = yMin; y <= yMax; y++)
+      {
+        const bool edge = (y == cy - ring) || (y == cy + ring);
+        for (int64_t x = xMin; x <= xMax; x++)
+        {
+          if (!edge && x != cx - ring && x != cx + ring)
+          {
+            x = std::max(x, cx + ring - 1);
+            continue;
+          }
+          const std::vector<size_t>* cell = findCell(x, y);
+          if (cell != nullptr)
+          {
+            for (const size_t id : *cell)
+            {
+              consider(id);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<Candidate> sorted;
+  sorted.reserve(best.size());
+  while (!best.empty())
+  {
+    sorted.push_back(best.top());
+    best.pop();
+  }
+  std::sort(sorted.begin(), sorted.end());
+  for (const Candidate& candidate : sorted)
+  {
+    result.push_back(candidate.second);
+  }
+  return result;
+}
+
+uint64_t grechin::SpatialGrid::getKey(const int64_t x, const int64_t y)
+{
+  return (static_cast<uint64_t>(x) << 32) ^ (static_cast<uint64_t>(y) & 0xFFFFFFFFu);
+}
+
+int64_t grechin::SpatialGrid::getCell(const double value) const
+{
+  const double cell = std::floor(value / cellSize_);
+  return static_cast<int64_t>(std::max(-MAX_CELL_INDEX, std::min(MAX_CELL_INDEX, cell)));
+}
+
+double grechin::SpatialGrid::getCellCount(const cell_range_t& range)
+{
+  return (static_cast<double>(range.xMax) - range.xMin + 1) * (static_cast<double>(range.yMax) - range.yMin + 1);
+}
+
+grechin::SpatialGrid::cell_range_t grechin::SpatialGrid::getCells(const rectangle_t& frame) const
+{
+  return cell_range_t{
+    getCell(frame.pos.x - frame.width / 2),
+    getCell(frame.pos.y - frame.height / 2),
+    getCell(frame.pos.x + frame.width / 2),
+    getCell(frame.pos.y + frame.height / 2)
+  };
+}
+
+const std::vector<size_t>* grechin::SpatialGrid::findCell(const int64_t x, const int64_t y) const
+{
+  const CellMap::const_iterator cell = cells_.find(getKey(x, y));
+  return cell != cells_.end() ? &cell->second : nullptr;
+}
+
+double grechin::SpatialGrid::getDistance(const size_t id, const point_t& point) const
+{
+  const rectangle_t& frame = frames_[id];
+  const double dx = std::max(std::fabs(point.x - offset_.x - frame.pos.x) - frame.width / 2, 0.0);
+  const double dy = std::max(std::fabs(point.y - offset_.y - frame.pos.y) - frame.height / 2, 0.0);
+  return std::hypot(dx, dy);
+}
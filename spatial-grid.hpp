@@ -0,0 +1,56 @@
+#ifndef SPATIAL_GRID_HPP
+#define SPATIAL_GRID_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include "base-types.hpp"
+
+namespace grechin
+{
+  class SpatialGrid
+  {
+  public:
+    SpatialGrid();
+
+    size_t getSize() const;
+    double getCellSize() const;
+
+    void build(const std::vector<rectangle_t>&);
+    void insert(const size_t, const rectangle_t&);
+    void translate(const double, const double);
+    void clear();
+
+    std::vector<size_t> queryOverlapping(const rectangle_t&) const;
+    std::vector<size_t> queryPoint(const point_t&) const;
+    std::vector<size_t> nearest(const point_t&, const size_t) const;
+
+  private:
+    typedef std::unordered_map<uint64_t, std::vector<size_t>> CellMap;
+
+    struct cell_range_t
+    {
+      int64_t xMin;
+      int64_t yMin;
+      int64_t xMax;
+      int64_t yMax;
+    };
+
+    double cellSize_;
+    point_t offset_;
+    std::vector<rectangle_t> frames_;
+    std::vector<size_t> oversized_;
+    CellMap cells_;
+    cell_range_t extent_;
+
+    static uint64_t getKey(const int64_t, const int64_t);
+    static double getCellCount(const cell_range_t&);
+    int64_t getCell(const double) const;
+    cell_range_t getCells(const rectangle_t&) const;
+    const std::vector<size_t>* findCell(const int64_t, const int64_t) const;
+    double getDistance(const size_t, const point_t&) const;
+  };
+}
+
+#endif
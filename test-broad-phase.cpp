@@ -0,0 +1,100 @@
+#include <memory>
+#include <vector>
+#include <random>
+#include <boost/test/unit_test.hpp>
+
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "composite-shape.hpp"
+#include "broad-phase.hpp"
+#include "base-types.hpp"
+
+BOOST_AUTO_TEST_SUITE(broad_phase_test)
+
+std::vector<grechin::index_pair_t> findPairs(const std::vector<grechin::rectangle_t>& frames)
+{
+  std::vector<grechin::index_pair_t> pairs;
+  for (size_t i = 0; i < frames.size(); i++)
+  {
+    for (size_t j = i + 1; j < frames.size(); j++)
+    {
+      if (addition::isOverlapped(frames[i], frames[j]))
+      {
+        pairs.emplace_back(i, j);
+      }
+    }
+  }
+  return pairs;
+}
+
+std::vector<grechin::rectangle_t> getRandomFrames(const size_t count, const unsigned seed)
+{
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<double> size(0.5, 8);
+  std::uniform_real_distribution<double> coordinate(-100, 100);
+
+  std::vector<grechin::rectangle_t> frames;
+  for (size_t i = 0; i < count; i++)
+  {
+    frames.push_back({ size(generator), size(generator), { coordinate(generator), coordinate(generator) } });
+  }
+  return frames;
+}
+
+BOOST_AUTO_TEST_CASE(find_overlapping_test)
+{
+  const std::vector<grechin::rectangle_t> frames = getRandomFrames(1500, 3);
+  const std::vector<grechin::index_pair_t> expected = findPairs(frames);
+  const std::vector<grechin::index_pair_t> result = addition::findOverlapping(frames);
+
+  BOOST_CHECK(!expected.empty());
+  BOOST_CHECK(result == expected);
+}
+
+BOOST_AUTO_TEST_CASE(incremental_test)
+{
+  std::vector<grechin::rectangle_t> frames = getRandomFrames(1000, 11);
+  grechin::SweepAndPrune sweep;
+  sweep.update(frames);
+
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<double> step(-1, 1);
+  for (size_t frame = 0; frame < 5; frame++)
+  {
+    for (grechin::rectangle_t& rectangle : frames)
+    {
+      rectangle.pos.x += step(generator);
+      rectangle.pos.y += step(generator);
+    }
+    BOOST_CHECK(sweep.update(frames) == findPairs(frames));
+  }
+
+  frames.resize(10);
+  BOOST_CHECK(sweep.update(frames) == findPairs(frames));
+  BOOST_CHECK(sweep.getPairs() == findPairs(frames));
+}
+
+BOOST_AUTO_TEST_CASE(composite_test)
+{
+  grechin::CompositeShape arr;
+  arr.add(std::make_shared<grechin::Rectangle>(4, 2, grechin::point_t{ 0, 0 }));
+  arr.add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 10, 0 }));
+  arr.add(std::make_shared<grechin::Circle>(1.5, grechin::point_t{ 2.5, 0.5 }));
+  arr.add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 11, 1 }));
+
+  const std::vector<grechin::index_pair_t> pairs = addition::findOverlapping(arr);
+
+  BOOST_REQUIRE_EQUAL(pairs.size(), 2);
+  BOOST_CHECK(pairs[0] == grechin::index_pair_t(0, 2));
+  BOOST_CHECK(pairs[1] == grechin::index_pair_t(1, 3));
+
+  grechin::SweepAndPrune sweep;
+
+  BOOST_CHECK(sweep.update(arr) == pairs);
+
+  sweep.reset();
+
+  BOOST_CHECK(sweep.getPairs().empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,8 +2,11 @@
 
 #include <cmath>
 #include <memory>
+#include <memory_resource>
+#include <vector>
 #include <utility>
 #include <stdexcept>
+#include <algorithm>
 #include <boost/test/unit_test.hpp>
 
 #include "circle.hpp"
@@ -38,6 +41,21 @@ struct fixture_t
   std::shared_ptr<grechin::Circle> circ;
 };
 
+struct faulty_t : grechin::Rectangle
+{
+  using grechin::Rectangle::Rectangle;
+  using grechin::Rectangle::move;
+  void move(const double xMove, const double yMove) override
+  {
+    if (failing)
+    {
+      throw std::runtime_error("Move failed");
+    }
+    grechin::Rectangle::move(xMove, yMove);
+  }
+  bool failing = false;
+};
+
 BOOST_FIXTURE_TEST_CASE(valid_test, fixture_t)
 {
   std::shared_ptr<grechin::CompositeShape> comp = std::make_shared<grechin::CompositeShape>(arr);
@@ -179,6 +197,57 @@ BOOST_FIXTURE_TEST_CASE(move_operator_test, fixture_t)
   BOOST_CHECK_CLOSE(arrFullMove.getFrameRect().pos.y, arrFrame.pos.y, EPSILON);
 }
 
+BOOST_FIXTURE_TEST_CASE(copy_on_write_test, fixture_t)
+{
+  std::shared_ptr<grechin::CompositeShape> nested = std::make_shared<grechin::CompositeShape>();
+  nested->add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 30, 30 }));
+  arr.add(nested);
+  const grechin::rectangle_t arrFrame = arr.getFrameRect();
+
+  grechin::CompositeShape copy(arr);
+
+  BOOST_CHECK_EQUAL(copy[0], rect);
+  BOOST_CHECK_EQUAL(copy[2], nested);
+
+  copy.add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 0, 0 }));
+  copy.move(5, -5);
+  copy.scale(2);
+  copy.rotate(90);
+
+  BOOST_CHECK_EQUAL(copy.getSize(), 4);
+  BOOST_CHECK_EQUAL(arr.getSize(), 3);
+  BOOST_CHECK(copy[0] != rect);
+  BOOST_CHECK_CLOSE(copy[0]->getArea(), R_AREA * 4, EPSILON);
+  BOOST_CHECK_CLOSE(rect->getFrameRect().pos.x, R_CENTER.x, EPSILON);
+  BOOST_CHECK_CLOSE(rect->getFrameRect().width, WIDTH, EPSILON);
+  BOOST_CHECK_CLOSE(nested->getFrameRect().pos.x, 30, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getArea(), R_AREA + C_AREA + M_PI, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, arrFrame.width, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().pos.y, arrFrame.pos.y, EPSILON);
+
+  grechin::CompositeShape snapshot;
+  snapshot = arr;
+  arr.move(1, 1);
+  arr.markRemoved(1);
+
+  BOOST_CHECK_EQUAL(arr.getSize(), 2);
+  BOOST_REQUIRE_EQUAL(snapshot.getSize(), 3);
+  BOOST_CHECK_EQUAL(snapshot[0], rect);
+  BOOST_CHECK_EQUAL(snapshot[1], circ);
+  BOOST_CHECK_CLOSE(snapshot[0]->getFrameRect().pos.x, R_CENTER.x, EPSILON);
+  BOOST_CHECK_CLOSE(arr[0]->getFrameRect().pos.x, R_CENTER.x + 1, EPSILON);
+  BOOST_CHECK_CLOSE(snapshot.getFrameRect().pos.x, arrFrame.pos.x, EPSILON);
+
+  snapshot.removeIf([](const std::shared_ptr<grechin::Shape>&)
+  {
+    return true;
+  });
+
+  BOOST_CHECK_EQUAL(snapshot.getSize(), 0);
+  BOOST_CHECK_EQUAL(arr.getSize(), 2);
+  BOOST_CHECK_CLOSE(arr.getArea(), R_AREA + M_PI, EPSILON);
+}
+
 BOOST_FIXTURE_TEST_CASE(remove_test, fixture_t)
 {
   arr.remove(1);
@@ -414,6 +483,620 @@ BOOST_FIXTURE_TEST_CASE(rotate_negative_angle_test, fixture_t)
   BOOST_CHECK_CLOSE(arr[1]->getFrameRect().pos.y, circCenter.y, EPSILON);
 }
 
+BOOST_FIXTURE_TEST_CASE(reserve_test, fixture_t)
+{
+  arr.reserve(100);
+
+  BOOST_CHECK_EQUAL(arr.getSize(), 2);
+  BOOST_CHECK_EQUAL(arr.getCapacity(), 100);
+  BOOST_CHECK_EQUAL(rect, arr[0]);
+  BOOST_CHECK_EQUAL(circ, arr[1]);
+
+  arr.add(rect);
+
+  BOOST_CHECK_EQUAL(arr.getCapacity(), 100);
+
+  arr.shrink_to_fit();
+
+  BOOST_CHECK_EQUAL(arr.getSize(), 3);
+  BOOST_CHECK_EQUAL(arr.getCapacity(), 3);
+  BOOST_CHECK_EQUAL(rect, arr[2]);
+  BOOST_CHECK_CLOSE(arr.getArea(), R_AREA * 2 + C_AREA, EPSILON);
+}
+
+BOOST_FIXTURE_TEST_CASE(add_range_test, fixture_t)
+{
+  std::vector<std::shared_ptr<grechin::Shape>> shapes;
+  for (size_t i = 0; i < 1000; i++)
+  {
+    shapes.push_back(std::make_shared<grechin::Circle>(RADIUS, C_CENTER));
+  }
+
+  arr.add(shapes.begin(), shapes.end());
+
+  BOOST_CHECK_EQUAL(arr.getSize(), 1002);
+  BOOST_CHECK_EQUAL(rect, arr[0]);
+  BOOST_CHECK_EQUAL(circ, arr[1]);
+  BOOST_CHECK_EQUAL(shapes[999], arr[1001]);
+  BOOST_CHECK_EQUAL(shapes[999].use_count(), 2);
+  BOOST_CHECK_CLOSE(arr.getArea(), R_AREA + C_AREA * 1001, EPSILON);
+
+  shapes.push_back(nullptr);
+
+  BOOST_CHECK_THROW(arr.add(shapes.end() - 1, shapes.end()), std::invalid_argument);
+}
+
+BOOST_FIXTURE_TEST_CASE(add_move_test, fixture_t)
+{
+  std::shared_ptr<grechin::Shape> shape = std::make_shared<grechin::Circle>(RADIUS, C_CENTER);
+  const grechin::Shape* raw = shape.get();
+
+  arr.add(std::move(shape));
+
+  BOOST_CHECK(shape == nullptr);
+  BOOST_CHECK_EQUAL(arr.getSize(), 3);
+  BOOST_CHECK_EQUAL(arr[2].get(), raw);
+  BOOST_CHECK_EQUAL(arr[2].use_count(), 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(swap_remove_test, fixture_t)
+{
+  std::shared_ptr<grechin::Circle> last = std::make_shared<grechin::Circle>(1, grechin::point_t{ 8, 10 });
+  arr.add(last);
+  arr.move(1, 2);
+  arr.swapRemove(0);
+
+  BOOST_CHECK_EQUAL(arr.getSize(), 2);
+  BOOST_CHECK_EQUAL(arr[0], last);
+  BOOST_CHECK_EQUAL(arr[1], circ);
+  BOOST_CHECK_CLOSE(arr.getArea(), C_AREA + M_PI, EPSILON);
+  BOOST_CHECK_CLOSE(rect->getFrameRect().pos.x, R_CENTER.x + 1, EPSILON);
+  BOOST_CHECK_CLOSE(rect->getFrameRect().pos.y, R_CENTER.y + 2, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().pos.y, (C_CENTER.y - RADIUS + 11) / 2 + 2, EPSILON);
+
+  arr.swapRemove(1);
+
+  BOOST_CHECK_EQUAL(arr.getSize(), 1);
+  BOOST_CHECK_EQUAL(arr[0], last);
+  BOOST_CHECK_THROW(arr.swapRemove(1), std::out_of_range);
+}
+
+BOOST_FIXTURE_TEST_CASE(remove_batch_test, fixture_t)
+{
+  for (size_t i = 0; i < 10; i++)
+  {
+    arr.add(std::make_shared<grechin::Circle>(1 + i, grechin::point_t{ 0, 0 }));
+  }
+
+  const size_t removed = arr.removeIf([](const std::shared_ptr<grechin::Shape>& shape)
+  {
+    return shape->getArea() > 50 * M_PI;
+  });
+
+  BOOST_CHECK_EQUAL(removed, 3);
+  BOOST_REQUIRE_EQUAL(arr.getSize(), 9);
+  BOOST_CHECK_EQUAL(arr[0], rect);
+  BOOST_CHECK_EQUAL(arr[1], circ);
+  BOOST_CHECK_CLOSE(arr[8]->getArea(), 49 * M_PI, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getArea(), R_AREA + C_AREA + 140 * M_PI, EPSILON);
+
+  const std::vector<size_t> numbers = { 8, 0, 2, 8 };
+
+  BOOST_CHECK_EQUAL(arr.removeIndices(numbers), 3);
+  BOOST_REQUIRE_EQUAL(arr.getSize(), 6);
+  BOOST_CHECK_EQUAL(arr[0], circ);
+  BOOST_CHECK_CLOSE(arr[1]->getArea(), 4 * M_PI, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getArea(), C_AREA + 90 * M_PI, EPSILON);
+  BOOST_CHECK_THROW(arr.removeIndices({ 1, 6 }), std::out_of_range);
+  BOOST_CHECK_EQUAL(arr.getSize(), 6);
+}
+
+BOOST_FIXTURE_TEST_CASE(mark_removed_test, fixture_t)
+{
+  std::shared_ptr<grechin::Circle> last = std::make_shared<grechin::Circle>(1, grechin::point_t{ 8, 10 });
+  arr.add(last);
+  arr.markRemoved(0);
+  arr.markRemoved(2);
+
+  BOOST_CHECK_EQUAL(arr.getSize(), 1);
+  BOOST_CHECK_CLOSE(arr.getArea(), C_AREA, EPSILON);
+  BOOST_CHECK_THROW(arr.markRemoved(2), std::logic_error);
+
+  arr.add(last);
+  arr.markRemoved(3);
+  arr.move(1, 1);
+
+  BOOST_CHECK_EQUAL(arr.getSize(), 1);
+  BOOST_CHECK_EQUAL(arr[0], circ);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().pos.x, C_CENTER.x + 1, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, RADIUS * 2, EPSILON);
+  BOOST_CHECK_EQUAL(arr.getCapacity(), 4);
+
+  arr.markRemoved(0);
+
+  BOOST_CHECK_EQUAL(arr.getSize(), 0);
+  BOOST_CHECK_EQUAL(arr.getArea(), 0);
+  BOOST_CHECK_THROW(arr.move(1, 1), std::logic_error);
+}
+
+BOOST_FIXTURE_TEST_CASE(frame_cache_test, fixture_t)
+{
+  const grechin::rectangle_t arrFrame = arr.getFrameRect();
+  const grechin::point_t farCenter = { 100, 50 };
+
+  arr.add(std::make_shared<grechin::Circle>(RADIUS, farCenter));
+
+  const double xMin = arrFrame.pos.x - arrFrame.width / 2;
+  const double yMin = arrFrame.pos.y - arrFrame.height / 2;
+  const double xMax = farCenter.x + RADIUS;
+  const double yMax = farCenter.y + RADIUS;
+
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, xMax - xMin, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().height, yMax - yMin, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().pos.x, (xMax + xMin) / 2, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().pos.y, (yMax + yMin) / 2, EPSILON);
+
+  arr.move(-5, 3);
+
+  BOOST_CHECK_CLOSE(arr.getFrameRect().pos.x, (xMax + xMin) / 2 - 5, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().pos.y, (yMax + yMin) / 2 + 3, EPSILON);
+
+  arr.remove(2);
+  arr.move(5, -3);
+
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, arrFrame.width, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().height, arrFrame.height, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().pos.x, arrFrame.pos.x, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().pos.y, arrFrame.pos.y, EPSILON);
+
+  arr.add(std::make_shared<grechin::Circle>(RADIUS, farCenter));
+  arr.scale(1.3);
+  arr.remove(2);
+
+  const grechin::rectangle_t rectFrame = arr[0]->getFrameRect();
+  const grechin::rectangle_t circFrame = arr[1]->getFrameRect();
+  const double left = std::min(rectFrame.pos.x - rectFrame.width / 2, circFrame.pos.x - circFrame.width / 2);
+  const double right = std::max(rectFrame.pos.x + rectFrame.width / 2, circFrame.pos.x + circFrame.width / 2);
+  const double bottom = std::min(rectFrame.pos.y - rectFrame.height / 2, circFrame.pos.y - circFrame.height / 2);
+  const double top = std::max(rectFrame.pos.y + rectFrame.height / 2, circFrame.pos.y + circFrame.height / 2);
+
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, right - left, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().height, top - bottom, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().pos.x, (right + left) / 2, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().pos.y, (top + bottom) / 2, EPSILON);
+}
+
+BOOST_FIXTURE_TEST_CASE(area_cache_test, fixture_t)
+{
+  BOOST_CHECK(arr.isCompensated());
+
+  for (size_t i = 0; i < 100000; i++)
+  {
+    arr.add(std::make_shared<grechin::Rectangle>(1e-3, 1e-7, R_CENTER));
+    arr.add(std::make_shared<grechin::Circle>(1e4, C_CENTER));
+    arr.remove(3);
+    arr.remove(2);
+  }
+
+  BOOST_CHECK_EQUAL(arr.getSize(), 2);
+  BOOST_CHECK_CLOSE(arr.getArea(), R_AREA + C_AREA, 1e-9);
+
+  arr.setCompensated(false);
+  arr.scale(2);
+
+  BOOST_CHECK(!arr.isCompensated());
+  BOOST_CHECK_CLOSE(arr.getArea(), (R_AREA + C_AREA) * 4, EPSILON);
+
+  arr.remove(1);
+  arr.remove(0);
+
+  BOOST_CHECK_EQUAL(arr.getArea(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(nested_cache_test)
+{
+  std::shared_ptr<grechin::CompositeShape> inner = std::make_shared<grechin::CompositeShape>();
+  inner->add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 0, 0 }));
+  grechin::CompositeShape arr;
+  arr.add(inner);
+
+  BOOST_CHECK_CLOSE(arr.getArea(), M_PI, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, 2, EPSILON);
+
+  inner->add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 10, 0 }));
+
+  BOOST_CHECK_CLOSE(arr.getArea(), 2 * M_PI, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, 12, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().pos.x, 5, EPSILON);
+
+  arr[0]->scale(2);
+
+  BOOST_CHECK_CLOSE(arr.getArea(), 8 * M_PI, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, 24, EPSILON);
+
+  std::shared_ptr<grechin::CompositeShape> deep = std::make_shared<grechin::CompositeShape>();
+  deep->add(std::make_shared<grechin::Rectangle>(2, 2, grechin::point_t{ 5, 20 }));
+  inner->add(deep);
+
+  BOOST_CHECK_CLOSE(arr.getArea(), 8 * M_PI + 4, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().height, 23, EPSILON);
+
+  deep->move(0, 10);
+
+  BOOST_CHECK_CLOSE(arr.getFrameRect().height, 33, EPSILON);
+  BOOST_CHECK_EQUAL(arr.queryPoint({ 5, 30 }).size(), 1);
+
+  arr.add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 50, 0 }));
+  arr.move(0, 1);
+  deep->scale(2);
+
+  BOOST_CHECK_CLOSE(arr.getArea(), 9 * M_PI + 16, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().height, 34, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, 58, EPSILON);
+
+  deep->remove(0);
+
+  BOOST_CHECK_THROW(arr.move(0, 1), std::logic_error);
+  BOOST_CHECK_THROW(arr.scale(2), std::logic_error);
+
+  inner->remove(0);
+  arr.remove(0);
+
+  BOOST_CHECK_CLOSE(arr.getArea(), M_PI, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, 2, EPSILON);
+}
+
+BOOST_AUTO_TEST_CASE(leaf_edit_test)
+{
+  grechin::CompositeShape arr;
+  arr.add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 0, 0 }));
+
+  BOOST_CHECK_CLOSE(arr.getArea(), M_PI, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, 2, EPSILON);
+
+  arr[0]->scale(2);
+
+  BOOST_CHECK_CLOSE(arr.getArea(), 4 * M_PI, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, 4, EPSILON);
+
+  const std::shared_ptr<grechin::Rectangle> rect = std::make_shared<grechin::Rectangle>(2, 2, grechin::point_t{ 10, 0 });
+  std::shared_ptr<grechin::CompositeShape> inner = std::make_shared<grechin::CompositeShape>();
+  inner->add(rect);
+  arr.add(inner);
+  grechin::CompositeShape other;
+  other.add(rect);
+
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, 13, EPSILON);
+
+  rect->setWidth(6);
+
+  BOOST_CHECK_CLOSE(arr.getArea(), 4 * M_PI + 12, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, 15, EPSILON);
+  BOOST_CHECK_CLOSE(other.getArea(), 12, EPSILON);
+  BOOST_CHECK_CLOSE(other.getFrameRect().width, 6, EPSILON);
+
+  arr.rotate(90);
+  rect->move({ 20, 20 });
+
+  BOOST_CHECK_CLOSE(arr.getFrameRect().height, 30.5, EPSILON);
+  BOOST_CHECK_CLOSE(other.getFrameRect().height, 6, EPSILON);
+  BOOST_CHECK_CLOSE(other.getFrameRect().pos.y, 20, EPSILON);
+  BOOST_CHECK_EQUAL(arr.queryPoint({ 20, 20 }).size(), 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(deferred_transform_test, fixture_t)
+{
+  std::shared_ptr<grechin::CompositeShape> nested = std::make_shared<grechin::CompositeShape>();
+  nested->add(std::make_shared<grechin::Rectangle>(2, 3, grechin::point_t{ -4, 1 }, 30));
+  nested->add(std::make_shared<grechin::Circle>(1.5, grechin::point_t{ 3, 8 }));
+  arr.add(std::make_shared<grechin::Rectangle>(4, 1, grechin::point_t{ 20, 5 }, 45));
+
+  grechin::CompositeShape eager;
+  eager.add(std::make_shared<grechin::Rectangle>(WIDTH, HEIGHT, R_CENTER));
+  eager.add(std::make_shared<grechin::Circle>(RADIUS, C_CENTER));
+  eager.add(std::make_shared<grechin::Rectangle>(4, 1, grechin::point_t{ 20, 5 }, 45));
+
+  arr.move(2, 2);
+  arr.scale(1.5);
+  eager.move(2, 2);
+  eager.scale(1.5);
+  eager.flush();
+
+  BOOST_CHECK_CLOSE(rect->getFrameRect().pos.x, R_CENTER.x, EPSILON);
+  BOOST_CHECK_CLOSE(rect->getFrameRect().pos.y, R_CENTER.y, EPSILON);
+
+  const double angles[] = { 30, 90, -45, 200 };
+  for (const double angle : angles)
+  {
+    arr.move(1.5, -2);
+    arr.scale(1.3);
+    arr.rotate(angle);
+    arr.add(std::make_shared<grechin::Rectangle>(3, 2, grechin::point_t{ angle, 1 }, 15));
+    arr.scale(0.9);
+    arr.add(std::make_shared<grechin::Circle>(1, grechin::point_t{ -4, angle }));
+    eager.move(1.5, -2);
+    eager.flush();
+    eager.scale(1.3);
+    eager.flush();
+    eager.rotate(angle);
+    eager.flush();
+    eager.add(std::make_shared<grechin::Rectangle>(3, 2, grechin::point_t{ angle, 1 }, 15));
+    eager.scale(0.9);
+    eager.flush();
+    eager.add(std::make_shared<grechin::Circle>(1, grechin::point_t{ -4, angle }));
+  }
+
+  BOOST_CHECK_CLOSE(arr.getArea(), eager.getArea(), EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, eager.getFrameRect().width, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().pos.x, eager.getFrameRect().pos.x, EPSILON);
+  for (size_t i = 0; i < arr.getSize(); i++)
+  {
+    BOOST_CHECK_CLOSE(arr[i]->getFrameRect().width, eager[i]->getFrameRect().width, EPSILON);
+    BOOST_CHECK_CLOSE(arr[i]->getFrameRect().height, eager[i]->getFrameRect().height, EPSILON);
+    BOOST_CHECK_CLOSE(arr[i]->getFrameRect().pos.x, eager[i]->getFrameRect().pos.x, EPSILON);
+    BOOST_CHECK_CLOSE(arr[i]->getFrameRect().pos.y, eager[i]->getFrameRect().pos.y, EPSILON);
+  }
+
+  grechin::CompositeShape group;
+  group.add(nested);
+  group.add(std::make_shared<grechin::Circle>(2, grechin::point_t{ 10, 10 }));
+  const grechin::rectangle_t nestedFrame = nested->getFrameRect();
+  const grechin::rectangle_t groupFrame = group.getFrameRect();
+
+  group.move(3, 4);
+  group.scale(2);
+
+  const double xCenter = groupFrame.pos.x + 3 + (nestedFrame.pos.x - groupFrame.pos.x) * 2;
+  const double yCenter = groupFrame.pos.y + 4 + (nestedFrame.pos.y - groupFrame.pos.y) * 2;
+
+  BOOST_CHECK_CLOSE(group.getFrameRect().width, groupFrame.width * 2, EPSILON);
+  BOOST_CHECK_CLOSE(group[0]->getFrameRect().width, nestedFrame.width * 2, EPSILON);
+  BOOST_CHECK_CLOSE(group[0]->getFrameRect().pos.x, xCenter, EPSILON);
+  BOOST_CHECK_CLOSE(group[0]->getFrameRect().pos.y, yCenter, EPSILON);
+}
+
+BOOST_FIXTURE_TEST_CASE(deferred_add_test, fixture_t)
+{
+  const std::shared_ptr<grechin::Circle> shared = std::make_shared<grechin::Circle>(1, grechin::point_t{ 0, 0 });
+  grechin::CompositeShape other;
+  other.add(shared);
+
+  arr.scale(4);
+  arr.move(100, 0);
+  arr.add(shared);
+  const std::shared_ptr<grechin::Circle> emplaced = arr.emplaceCircle(1, { 5, 5 });
+
+  BOOST_CHECK_CLOSE(shared->getRadius(), 1, EPSILON);
+  BOOST_CHECK_CLOSE(shared->getFrameRect().pos.x, 0, EPSILON);
+  BOOST_CHECK_CLOSE(other.getFrameRect().width, 2, EPSILON);
+  BOOST_CHECK_CLOSE(emplaced->getRadius(), 1, EPSILON);
+  BOOST_CHECK_CLOSE(emplaced->getFrameRect().pos.x, 5, EPSILON);
+  BOOST_CHECK_EQUAL(arr[2], shared);
+  BOOST_CHECK_CLOSE(arr[3]->getFrameRect().pos.y, 5, EPSILON);
+  BOOST_CHECK_CLOSE(arr[0]->getFrameRect().width, WIDTH * 4, EPSILON);
+}
+
+BOOST_AUTO_TEST_CASE(deferred_exception_test)
+{
+  std::shared_ptr<faulty_t> faulty = std::make_shared<faulty_t>(WIDTH, HEIGHT, R_CENTER);
+  grechin::CompositeShape arr;
+  arr.add(faulty);
+  arr.add(std::make_shared<grechin::Circle>(RADIUS, C_CENTER));
+  arr.move(1, 2);
+  faulty->failing = true;
+
+  BOOST_CHECK_THROW(arr.flush(), std::runtime_error);
+
+  faulty->failing = false;
+  arr.flush();
+
+  BOOST_CHECK_CLOSE(arr[0]->getFrameRect().pos.x, R_CENTER.x + 1, EPSILON);
+  BOOST_CHECK_CLOSE(arr[0]->getFrameRect().pos.y, R_CENTER.y + 2, EPSILON);
+  BOOST_CHECK_CLOSE(arr[1]->getFrameRect().pos.x, C_CENTER.x + 1, EPSILON);
+  BOOST_CHECK_CLOSE(arr[1]->getFrameRect().pos.y, C_CENTER.y + 2, EPSILON);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_test)
+{
+  grechin::CompositeShape serial;
+  grechin::CompositeShape parallel;
+  parallel.setExecutionPolicy({ true, true, 0, 4 });
+
+  for (size_t i = 0; i < 2000; i++)
+  {
+    const grechin::point_t center = { i * 0.37, i * -1.3 + 4 };
+    if (i % 2 == 0)
+    {
+      serial.add(std::make_shared<grechin::Circle>(1 + i % 7, center));
+      parallel.add(std::make_shared<grechin::Circle>(1 + i % 7, center));
+    }
+    else
+    {
+      serial.add(std::make_shared<grechin::Rectangle>(1 + i % 5, 2 + i % 3, center, i % 90));
+      parallel.add(std::make_shared<grechin::Rectangle>(1 + i % 5, 2 + i % 3, center, i % 90));
+    }
+  }
+
+  serial.move(2.5, -1);
+  parallel.move(2.5, -1);
+  serial.scale(1.7);
+  parallel.scale(1.7);
+  serial.rotate(35);
+  parallel.rotate(35);
+  serial.refresh();
+  parallel.refresh();
+
+  BOOST_CHECK_EQUAL(parallel.getArea(), serial.getArea());
+  BOOST_CHECK_EQUAL(parallel.getFrameRect().width, serial.getFrameRect().width);
+  BOOST_CHECK_EQUAL(parallel.getFrameRect().height, serial.getFrameRect().height);
+  BOOST_CHECK_EQUAL(parallel.getFrameRect().pos.x, serial.getFrameRect().pos.x);
+  BOOST_CHECK_EQUAL(parallel.getFrameRect().pos.y, serial.getFrameRect().pos.y);
+
+  for (size_t i = 0; i < serial.getSize(); i += 97)
+  {
+    BOOST_CHECK_EQUAL(parallel[i]->getFrameRect().pos.x, serial[i]->getFrameRect().pos.x);
+    BOOST_CHECK_EQUAL(parallel[i]->getFrameRect().pos.y, serial[i]->getFrameRect().pos.y);
+  }
+
+  parallel.setExecutionPolicy({ true, false, 0, 4 });
+  parallel.refresh();
+
+  BOOST_CHECK_CLOSE(parallel.getArea(), serial.getArea(), EPSILON);
+
+  parallel.add(std::make_shared<grechin::CompositeShape>());
+
+  BOOST_CHECK_THROW(parallel.move(1, 1), std::logic_error);
+}
+
+BOOST_FIXTURE_TEST_CASE(shared_subtree_test, fixture_t)
+{
+  std::shared_ptr<grechin::CompositeShape> first = std::make_shared<grechin::CompositeShape>();
+  std::shared_ptr<grechin::CompositeShape> second = std::make_shared<grechin::CompositeShape>();
+  first->add(circ);
+  second->add(circ);
+  second->add(first);
+  arr.add(first);
+  arr.add(second);
+
+  size_t count = 0;
+  double area = 0;
+  arr.forEachLeaf([&count, &area](const grechin::Shape& shape, const size_t multiplicity)
+  {
+    count += multiplicity;
+    area += shape.getArea() * multiplicity;
+  });
+
+  BOOST_CHECK_EQUAL(arr.getLeafCount(), 2);
+  BOOST_CHECK_EQUAL(count, 5);
+  BOOST_CHECK_CLOSE(arr.getArea(), R_AREA + 4 * C_AREA, EPSILON);
+  BOOST_CHECK_CLOSE(area, arr.getArea(), EPSILON);
+
+  arr.move(2, 3);
+  const grechin::point_t center = arr.getFrameRect().pos;
+  arr.scale(2);
+  arr.flush();
+
+  BOOST_CHECK_CLOSE(circ->getRadius(), RADIUS * 2, EPSILON);
+  BOOST_CHECK_CLOSE(circ->getFrameRect().pos.x, center.x + 2 * (C_CENTER.x + 2 - center.x), EPSILON);
+  BOOST_CHECK_CLOSE(circ->getFrameRect().pos.y, center.y + 2 * (C_CENTER.y + 3 - center.y), EPSILON);
+  BOOST_CHECK_CLOSE(arr.getArea(), (R_AREA + 4 * C_AREA) * 4, EPSILON);
+  BOOST_CHECK_CLOSE(second->getArea(), C_AREA * 8, EPSILON);
+  BOOST_CHECK_CLOSE(first->getFrameRect().pos.x, circ->getFrameRect().pos.x, EPSILON);
+
+  const grechin::point_t pivot = arr.getFrameRect().pos;
+  grechin::point_t circCenter = circ->getFrameRect().pos;
+  addition::revolve(circCenter, pivot, 30);
+  arr.rotate(30);
+
+  BOOST_CHECK_CLOSE(circ->getFrameRect().pos.x, circCenter.x, EPSILON);
+  BOOST_CHECK_CLOSE(circ->getFrameRect().pos.y, circCenter.y, EPSILON);
+  BOOST_CHECK_CLOSE(second->getFrameRect().pos.y, circCenter.y, EPSILON);
+
+  second->add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 0, 0 }));
+
+  BOOST_CHECK_EQUAL(arr.getLeafCount(), 3);
+
+  std::shared_ptr<grechin::CompositeShape> cycle = std::make_shared<grechin::CompositeShape>();
+  cycle->add(rect);
+  first->add(cycle);
+  cycle->add(second);
+
+  BOOST_CHECK_THROW(arr.getLeafCount(), std::logic_error);
+
+  cycle->remove(1);
+
+  BOOST_CHECK_EQUAL(arr.getLeafCount(), 3);
+}
+
+BOOST_FIXTURE_TEST_CASE(spatial_query_test, fixture_t)
+{
+  std::vector<size_t> result = arr.queryPoint(R_CENTER);
+
+  BOOST_REQUIRE_EQUAL(result.size(), 1);
+  BOOST_CHECK_EQUAL(result[0], 0);
+
+  arr.add(std::make_shared<grechin::Circle>(RADIUS, R_CENTER));
+  result = arr.queryPoint(R_CENTER);
+
+  BOOST_REQUIRE_EQUAL(result.size(), 2);
+  BOOST_CHECK_EQUAL(result[1], 2);
+
+  arr.move(100, 100);
+
+  BOOST_CHECK(arr.queryPoint(R_CENTER).empty());
+  BOOST_CHECK_EQUAL(arr.queryOverlapping({ 1, 1, { C_CENTER.x + 100, C_CENTER.y + 100 } }).size(), 1);
+
+  arr.remove(0);
+  result = arr.nearest({ R_CENTER.x + 100, R_CENTER.y + 100 }, 1);
+
+  BOOST_REQUIRE_EQUAL(result.size(), 1);
+  BOOST_CHECK_EQUAL(result[0], 1);
+}
+
+struct counting_resource_t : std::pmr::memory_resource
+{
+  counting_resource_t() :
+    allocations(0)
+  {}
+
+  void* do_allocate(size_t bytes, size_t alignment) override
+  {
+    allocations++;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* pointer, size_t bytes, size_t alignment) override
+  {
+    allocations--;
+    std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+  {
+    return this == &other;
+  }
+
+  int allocations;
+};
+
+BOOST_AUTO_TEST_CASE(emplace_test)
+{
+  std::shared_ptr<grechin::Circle> circle;
+  {
+    grechin::CompositeShape arr;
+    circle = arr.emplaceCircle(RADIUS, C_CENTER);
+    std::shared_ptr<grechin::Rectangle> rect = arr.emplaceRectangle(WIDTH, HEIGHT, R_CENTER, 90);
+
+    BOOST_CHECK(arr.getArena() != nullptr);
+    BOOST_CHECK_EQUAL(arr.getSize(), 2);
+    BOOST_CHECK_EQUAL(circle, arr[0]);
+    BOOST_CHECK_EQUAL(rect, arr[1]);
+    BOOST_CHECK_CLOSE(arr.getArea(), R_AREA + C_AREA, EPSILON);
+    BOOST_CHECK_CLOSE(rect->getFrameRect().width, HEIGHT, EPSILON);
+    BOOST_CHECK_THROW(arr.emplaceCircle(-1, C_CENTER), std::invalid_argument);
+
+    grechin::CompositeShape copy(arr);
+
+    BOOST_CHECK(copy.getArena() == nullptr);
+  }
+
+  BOOST_CHECK_CLOSE(circle->getArea(), C_AREA, EPSILON);
+
+  std::shared_ptr<counting_resource_t> resource = std::make_shared<counting_resource_t>();
+  {
+    grechin::CompositeShape arr;
+    arr.setArena(resource);
+    for (size_t i = 0; i < 10; i++)
+    {
+      arr.emplaceCircle(RADIUS, C_CENTER);
+    }
+
+    BOOST_CHECK_EQUAL(resource->allocations, 10);
+  }
+
+  BOOST_CHECK_EQUAL(resource->allocations, 0);
+}
+
 BOOST_FIXTURE_TEST_CASE(exception_add_test, fixture_t)
 {
   BOOST_CHECK_THROW(arr.add(nullptr), std::invalid_argument);
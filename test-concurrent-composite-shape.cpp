@@ -0,0 +1,192 @@
+#define _USE_MATH_DEFINES
+
+#include <cmath>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "composite-shape.hpp"
+#include "concurrent-composite-shape.hpp"
+#include "base-types.hpp"
+
+BOOST_AUTO_TEST_SUITE(concurrent_composite_shape_test)
+
+const double EPSILON = 0.00001;
+
+BOOST_AUTO_TEST_CASE(snapshot_test)
+{
+  grechin::CompositeShape initial;
+  initial.add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 0, 0 }));
+  grechin::ConcurrentCompositeShape arr(initial);
+  const grechin::ConcurrentCompositeShape::Snapshot before = arr.getSnapshot();
+
+  arr.add(std::make_shared<grechin::Rectangle>(2, 4, grechin::point_t{ 5, 0 }));
+  arr.move(10, -2);
+  arr.scale(2);
+
+  BOOST_CHECK_EQUAL(before->getSize(), 1);
+  BOOST_CHECK_CLOSE(before->getArea(), M_PI, EPSILON);
+  BOOST_CHECK_CLOSE((*before)[0]->getFrameRect().pos.x + 1, 1, EPSILON);
+  BOOST_CHECK_CLOSE(before->getFrameRect().width, 2, EPSILON);
+
+  BOOST_CHECK_EQUAL(arr.getSize(), 2);
+  BOOST_CHECK_CLOSE(arr.getArea(), 4 * (M_PI + 8), EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, 14, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getSnapshot()->getFrameRect().pos.x, 12.5, EPSILON);
+  BOOST_CHECK_EQUAL(initial.getSize(), 1);
+  BOOST_CHECK_CLOSE(initial[0]->getFrameRect().pos.x + 1, 1, EPSILON);
+}
+
+BOOST_AUTO_TEST_CASE(update_test)
+{
+  grechin::ConcurrentCompositeShape arr;
+  const grechin::ConcurrentCompositeShape::Snapshot empty = arr.getSnapshot();
+
+  BOOST_CHECK_EQUAL(arr.getSize(), 0);
+  BOOST_CHECK_EQUAL(arr.getArea(), 0);
+
+  arr.update([](grechin::CompositeShape& shape)
+  {
+    shape.add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 0, 0 }));
+    shape.add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 3, 0 }));
+    shape.rotate(90);
+  });
+  const grechin::ConcurrentCompositeShape::Snapshot filled = arr.getSnapshot();
+
+  BOOST_CHECK(filled != empty);
+  BOOST_CHECK_EQUAL(empty->getSize(), 0);
+  BOOST_CHECK_EQUAL(filled->getSize(), 2);
+  BOOST_CHECK_CLOSE(filled->getFrameRect().height, 5, EPSILON);
+
+  BOOST_CHECK_THROW(arr.update([](grechin::CompositeShape& shape)
+  {
+    shape.remove(0);
+    shape.add(nullptr);
+  }), std::invalid_argument);
+  BOOST_CHECK_THROW(arr.remove(2), std::out_of_range);
+
+  BOOST_CHECK(arr.getSnapshot() == filled);
+  BOOST_CHECK_EQUAL(arr.getSize(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(nested_test)
+{
+  std::shared_ptr<grechin::CompositeShape> nested = std::make_shared<grechin::CompositeShape>();
+  nested->add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 0, 0 }));
+  nested->add(std::make_shared<grechin::Rectangle>(2, 2, grechin::point_t{ 4, 0 }));
+  grechin::ConcurrentCompositeShape arr;
+  arr.add(nested);
+  const grechin::ConcurrentCompositeShape::Snapshot before = arr.getSnapshot();
+
+  arr.move(100, 0);
+  arr.rotate(90);
+
+  BOOST_CHECK_CLOSE(before->getFrameRect().pos.x, 2, EPSILON);
+  BOOST_CHECK_CLOSE((*before)[0]->getFrameRect().width, 6, EPSILON);
+  BOOST_CHECK_CLOSE(nested->getFrameRect().pos.x, 2, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().pos.x, 102, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().height, 6, EPSILON);
+  BOOST_CHECK_EQUAL(arr.getSnapshot()->getLeafCount(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(nested_change_test)
+{
+  std::shared_ptr<grechin::CompositeShape> inner = std::make_shared<grechin::CompositeShape>();
+  inner->add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 0, 0 }));
+  grechin::ConcurrentCompositeShape arr;
+  arr.add(inner);
+  arr.add(std::make_shared<grechin::Circle>(1, grechin::point_t{ -4, 0 }));
+
+  BOOST_CHECK_CLOSE(arr.getArea(), 2 * M_PI, EPSILON);
+
+  inner->add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 4, 0 }));
+
+  BOOST_CHECK_CLOSE(arr.getArea(), 3 * M_PI, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, 10, EPSILON);
+
+  inner->scale(2);
+
+  BOOST_CHECK_CLOSE(arr.getSnapshot()->getArea(), 9 * M_PI, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().width, 13, EPSILON);
+
+  arr.move(1, 0);
+
+  BOOST_CHECK_CLOSE(arr.getArea(), 9 * M_PI, EPSILON);
+  BOOST_CHECK_CLOSE(arr.getFrameRect().pos.x, 2.5, EPSILON);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_readers_test)
+{
+  grechin::ConcurrentCompositeShape arr;
+  const size_t edits = 300;
+  std::atomic<bool> done(false);
+  std::atomic<size_t> failures(0);
+  std::atomic<size_t> reads(0);
+
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < 3; i++)
+  {
+    readers.emplace_back([&]()
+    {
+      while (!done.load())
+      {
+        const grechin::ConcurrentCompositeShape::Snapshot snapshot = arr.getSnapshot();
+        const size_t size = snapshot->getSize();
+        double area = 0;
+        double right = 0;
+        for (size_t j = 0; j < size; j++)
+        {
+          area += (*snapshot)[j]->getArea();
+          const grechin::rectangle_t frame = (*snapshot)[j]->getFrameRect();
+          right = std::max(right, frame.pos.x + frame.width / 2);
+        }
+        size_t leaves = 0;
+        snapshot->forEachLeaf([&leaves](const grechin::Shape&, const size_t)
+        {
+          leaves++;
+        });
+        grechin::CompositeShape copy(*snapshot);
+        if (size != 0)
+        {
+          copy.move(0, 1);
+        }
+        const grechin::rectangle_t frame = snapshot->getFrameRect();
+        const bool valid = fabs(area - size * M_PI) < EPSILON && fabs(snapshot->getArea() - area) < EPSILON
+            && leaves == size && snapshot->queryPoint({ -1000, -1000 }).empty()
+            && (size == 0 || fabs(frame.pos.x + frame.width / 2 - right) < EPSILON)
+            && (size == 0 || fabs(copy.getFrameRect().pos.y - frame.pos.y - 1) < EPSILON);
+        failures += !valid;
+        reads++;
+      }
+    });
+  }
+
+  for (size_t i = 0; i < edits; i++)
+  {
+    arr.add(std::make_shared<grechin::Circle>(1, grechin::point_t{ static_cast<double>(i), 0 }));
+    if (i % 10 == 0)
+    {
+      arr.move(0.5, 0.25);
+    }
+  }
+  while (reads.load() < 100)
+  {
+    std::this_thread::yield();
+  }
+  done = true;
+  for (std::thread& reader : readers)
+  {
+    reader.join();
+  }
+
+  BOOST_CHECK_EQUAL(failures.load(), 0);
+  BOOST_CHECK_EQUAL(arr.getSize(), edits);
+  BOOST_CHECK_CLOSE(arr.getArea(), edits * M_PI, EPSILON);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,109 @@
+#include <memory>
+#include <variant>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "composite-shape.hpp"
+#include "flat-composite.hpp"
+#include "base-types.hpp"
+
+BOOST_AUTO_TEST_SUITE(flat_composite_test)
+
+const double EPSILON = 0.00001;
+
+struct fixture_t
+{
+  fixture_t() :
+    nested(std::make_shared<grechin::CompositeShape>())
+  {
+    nested->add(std::make_shared<grechin::Circle>(1.5, grechin::point_t{ -4.1, 2.0 }));
+    nested->add(std::make_shared<grechin::Rectangle>(2.0, 8.0, grechin::point_t{ 0.5, -7.5 }, 120));
+    arr.add(std::make_shared<grechin::Rectangle>(10.1, 6.9, grechin::point_t{ 7.2, 11.1 }, 30));
+    arr.add(std::make_shared<grechin::Circle>(3.2, grechin::point_t{ 14.6, -12.3 }));
+    arr.add(nested);
+  }
+  std::shared_ptr<grechin::CompositeShape> nested;
+  grechin::CompositeShape arr;
+};
+
+void checkFrame(const grechin::rectangle_t& lhs, const grechin::rectangle_t& rhs)
+{
+  BOOST_CHECK_CLOSE(lhs.width, rhs.width, EPSILON);
+  BOOST_CHECK_CLOSE(lhs.height, rhs.height, EPSILON);
+  BOOST_CHECK_CLOSE(lhs.pos.x, rhs.pos.x, EPSILON);
+  BOOST_CHECK_CLOSE(lhs.pos.y, rhs.pos.y, EPSILON);
+}
+
+BOOST_FIXTURE_TEST_CASE(conversion_test, fixture_t)
+{
+  grechin::FlatComposite flat(arr);
+
+  BOOST_REQUIRE_EQUAL(flat.getSize(), 3);
+  BOOST_CHECK(std::holds_alternative<grechin::Rectangle>(flat[0]));
+  BOOST_CHECK(std::holds_alternative<grechin::Circle>(flat[1]));
+  BOOST_CHECK(std::get<std::shared_ptr<grechin::CompositeShape>>(flat[2]) == nested);
+  BOOST_CHECK_CLOSE(flat.getArea(), arr.getArea(), EPSILON);
+  checkFrame(flat.getFrameRect(), arr.getFrameRect());
+  BOOST_CHECK_CLOSE(grechin::getArea(flat[1]), arr[1]->getArea(), EPSILON);
+  checkFrame(grechin::getFrameRect(flat[0]), arr[0]->getFrameRect());
+  BOOST_CHECK_THROW(flat[3], std::out_of_range);
+
+  flat.add(grechin::Circle(1, { 0, 0 }));
+  flat.remove(0);
+
+  BOOST_CHECK_EQUAL(flat.getSize(), 3);
+  BOOST_CHECK(std::holds_alternative<grechin::Circle>(flat[2]));
+  BOOST_CHECK_THROW(flat.remove(3), std::out_of_range);
+  BOOST_CHECK_THROW(flat.add(std::shared_ptr<grechin::CompositeShape>()), std::invalid_argument);
+}
+
+BOOST_FIXTURE_TEST_CASE(transform_test, fixture_t)
+{
+  grechin::FlatComposite flat(arr);
+  const grechin::rectangle_t nestedFrame = nested->getFrameRect();
+
+  flat.move(2.5, -1.5);
+  flat.scale(1.7);
+  flat.rotate(30);
+  flat.move({ 3, 4 });
+
+  checkFrame(nested->getFrameRect(), nestedFrame);
+
+  arr.move(2.5, -1.5);
+  arr.scale(1.7);
+  arr.rotate(30);
+  arr.move({ 3, 4 });
+
+  BOOST_CHECK_CLOSE(flat.getArea(), arr.getArea(), EPSILON);
+  checkFrame(flat.getFrameRect(), arr.getFrameRect());
+  for (size_t i = 0; i < flat.getSize(); i++)
+  {
+    checkFrame(grechin::getFrameRect(flat[i]), arr[i]->getFrameRect());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(invalid_test)
+{
+  grechin::FlatComposite flat;
+  grechin::CompositeShape arr;
+  struct shape_t : public grechin::Circle
+  {
+    shape_t() :
+      grechin::Circle(1, { 0, 0 })
+    {}
+  };
+  arr.add(std::make_shared<shape_t>());
+
+  BOOST_CHECK_THROW(grechin::FlatComposite{ arr }, std::invalid_argument);
+  BOOST_CHECK_THROW(flat.move(1, 1), std::logic_error);
+  BOOST_CHECK_THROW(flat.rotate(30), std::logic_error);
+  BOOST_CHECK_THROW(flat.scale(2), std::logic_error);
+
+  flat.add(grechin::Circle(1, { 0, 0 }));
+
+  BOOST_CHECK_THROW(flat.scale(-1), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,197 @@
+#define _USE_MATH_DEFINES
+
+#include <cmath>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "frame-kernels.hpp"
+#include "base-types.hpp"
+
+BOOST_AUTO_TEST_SUITE(frame_kernels_test)
+
+const double FRAME_EPSILON = 1e-12;
+const double SUM_EPSILON = 1e-10;
+const size_t COUNT = 1003;
+
+const grechin::kernels::Isa ISAS[] = {
+  grechin::kernels::Isa::scalar,
+  grechin::kernels::Isa::sse2,
+  grechin::kernels::Isa::avx2
+};
+
+struct fixture_t
+{
+  fixture_t() :
+    isa(grechin::kernels::getIsa())
+  {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> size(0.1, 20);
+    std::uniform_real_distribution<double> coordinate(-1000, 1000);
+    std::uniform_real_distribution<double> angle(-720, 720);
+
+    for (size_t i = 0; i < COUNT; i++)
+    {
+      radius.push_back(size(generator));
+      circleX.push_back(coordinate(generator));
+      circleY.push_back(coordinate(generator));
+      circles.emplace_back(radius.back(), grechin::point_t{ circleX.back(), circleY.back() });
+
+      width.push_back(size(generator));
+      height.push_back(size(generator));
+      rectX.push_back(coordinate(generator));
+      rectY.push_back(coordinate(generator));
+      const double rectAngle = angle(generator);
+      cosAngle.push_back(cos(rectAngle * M_PI / 180));
+      sinAngle.push_back(sin(rectAngle * M_PI / 180));
+      rectangles.emplace_back(width.back(), height.back(), grechin::point_t{ rectX.back(), rectY.back() }, rectAngle);
+    }
+  }
+
+  ~fixture_t()
+  {
+    grechin::kernels::setIsa(isa);
+  }
+
+  grechin::kernels::Isa isa;
+  std::vector<double> radius;
+  std::vector<double> circleX;
+  std::vector<double> circleY;
+  std::vector<double> width;
+  std::vector<double> height;
+  std::vector<double> rectX;
+  std::vector<double> rectY;
+  std::vector<double> cosAngle;
+  std::vector<double> sinAngle;
+  std::vector<grechin::Circle> circles;
+  std::vector<grechin::Rectangle> rectangles;
+};
+
+grechin::kernels::bounds_t getBounds(const grechin::rectangle_t& frame, const grechin::kernels::bounds_t& bounds)
+{
+  return grechin::kernels::bounds_t{
+    std::min(bounds.xMin, frame.pos.x - frame.width / 2),
+    std::min(bounds.yMin, frame.pos.y - frame.height / 2),
+    std::max(bounds.xMax, frame.pos.x + frame.width / 2),
+    std::max(bounds.yMax, frame.pos.y + frame.height / 2)
+  };
+}
+
+BOOST_FIXTURE_TEST_CASE(rectangle_frames_test, fixture_t)
+{
+  for (const grechin::kernels::Isa current : ISAS)
+  {
+    if (!grechin::kernels::isSupported(current))
+    {
+      continue;
+    }
+    grechin::kernels::setIsa(current);
+
+    std::vector<double> frameWidth(COUNT);
+    std::vector<double> frameHeight(COUNT);
+    grechin::kernels::rectangleFrames(width.data(), height.data(), cosAngle.data(), sinAngle.data(), COUNT,
+        frameWidth.data(), frameHeight.data());
+
+    for (size_t i = 0; i < COUNT; i++)
+    {
+      BOOST_CHECK_CLOSE(frameWidth[i], rectangles[i].getFrameRect().width, FRAME_EPSILON);
+      BOOST_CHECK_CLOSE(frameHeight[i], rectangles[i].getFrameRect().height, FRAME_EPSILON);
+    }
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(bounds_test, fixture_t)
+{
+  grechin::kernels::bounds_t circleExpected = grechin::kernels::getEmptyBounds();
+  grechin::kernels::bounds_t rectExpected = grechin::kernels::getEmptyBounds();
+  for (size_t i = 0; i < COUNT; i++)
+  {
+    circleExpected = getBounds(circles[i].getFrameRect(), circleExpected);
+    rectExpected = getBounds(rectangles[i].getFrameRect(), rectExpected);
+  }
+
+  for (const grechin::kernels::Isa current : ISAS)
+  {
+    if (!grechin::kernels::isSupported(current))
+    {
+      continue;
+    }
+    grechin::kernels::setIsa(current);
+
+    for (size_t count = 1; count <= 9; count++)
+    {
+      grechin::kernels::bounds_t expected = grechin::kernels::getEmptyBounds();
+      for (size_t i = 0; i < count; i++)
+      {
+        expected = getBounds(rectangles[i].getFrameRect(), expected);
+      }
+      grechin::kernels::bounds_t bounds = grechin::kernels::getEmptyBounds();
+      grechin::kernels::rectangleBounds(width.data(), height.data(), rectX.data(), rectY.data(), cosAngle.data(),
+          sinAngle.data(), count, bounds);
+
+      BOOST_CHECK_CLOSE(bounds.xMin, expected.xMin, FRAME_EPSILON);
+      BOOST_CHECK_CLOSE(bounds.yMin, expected.yMin, FRAME_EPSILON);
+      BOOST_CHECK_CLOSE(bounds.xMax, expected.xMax, FRAME_EPSILON);
+      BOOST_CHECK_CLOSE(bounds.yMax, expected.yMax, FRAME_EPSILON);
+    }
+
+    grechin::kernels::bounds_t bounds = grechin::kernels::getEmptyBounds();
+    grechin::kernels::circleBounds(radius.data(), circleX.data(), circleY.data(), COUNT, bounds);
+
+    BOOST_CHECK_CLOSE(bounds.xMin, circleExpected.xMin, FRAME_EPSILON);
+    BOOST_CHECK_CLOSE(bounds.yMin, circleExpected.yMin, FRAME_EPSILON);
+    BOOST_CHECK_CLOSE(bounds.xMax, circleExpected.xMax, FRAME_EPSILON);
+    BOOST_CHECK_CLOSE(bounds.yMax, circleExpected.yMax, FRAME_EPSILON);
+
+    bounds = grechin::kernels::getEmptyBounds();
+    grechin::kernels::rectangleBounds(width.data(), height.data(), rectX.data(), rectY.data(), cosAngle.data(),
+        sinAngle.data(), COUNT, bounds);
+
+    BOOST_CHECK_CLOSE(bounds.xMin, rectExpected.xMin, FRAME_EPSILON);
+    BOOST_CHECK_CLOSE(bounds.yMin, rectExpected.yMin, FRAME_EPSILON);
+    BOOST_CHECK_CLOSE(bounds.xMax, rectExpected.xMax, FRAME_EPSILON);
+    BOOST_CHECK_CLOSE(bounds.yMax, rectExpected.yMax, FRAME_EPSILON);
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(area_sum_test, fixture_t)
+{
+  double circleArea = 0;
+  double rectArea = 0;
+  for (size_t i = 0; i < COUNT; i++)
+  {
+    circleArea += circles[i].getArea();
+    rectArea += rectangles[i].getArea();
+  }
+
+  for (const grechin::kernels::Isa current : ISAS)
+  {
+    if (!grechin::kernels::isSupported(current))
+    {
+      continue;
+    }
+    grechin::kernels::setIsa(current);
+
+    BOOST_CHECK_CLOSE(grechin::kernels::circleAreaSum(radius.data(), COUNT), circleArea, SUM_EPSILON);
+    BOOST_CHECK_CLOSE(grechin::kernels::rectangleAreaSum(width.data(), height.data(), COUNT), rectArea,
+        SUM_EPSILON);
+    BOOST_CHECK_CLOSE(grechin::kernels::circleAreaSum(radius.data(), 1), circles[0].getArea(), FRAME_EPSILON);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(isa_test)
+{
+  BOOST_CHECK(grechin::kernels::isSupported(grechin::kernels::Isa::scalar));
+  BOOST_CHECK(grechin::kernels::isSupported(grechin::kernels::getIsa()));
+
+  if (!grechin::kernels::isSupported(grechin::kernels::Isa::avx2))
+  {
+    BOOST_CHECK_THROW(grechin::kernels::setIsa(grechin::kernels::Isa::avx2), std::invalid_argument);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
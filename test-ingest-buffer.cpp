@@ -0,0 +1,133 @@
+#include <memory>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+
+#include "circle.hpp"
+#include "composite-shape.hpp"
+#include "ingest-buffer.hpp"
+#include "base-types.hpp"
+
+BOOST_AUTO_TEST_SUITE(ingest_buffer_test)
+
+BOOST_AUTO_TEST_CASE(single_producer_test)
+{
+  const size_t count = 2 * grechin::INGEST_CHUNK + 100;
+  grechin::IngestBuffer buffer;
+  grechin::CompositeShape arr;
+  {
+    grechin::IngestBuffer::Producer producer(buffer);
+    for (size_t i = 0; i < count; i++)
+    {
+      producer.push(std::make_shared<grechin::Circle>(1, grechin::point_t{ static_cast<double>(i), 0 }));
+    }
+
+    BOOST_CHECK_EQUAL(buffer.getSize(), 2 * grechin::INGEST_CHUNK);
+
+    producer.flush();
+
+    BOOST_CHECK_EQUAL(buffer.getSize(), count);
+    BOOST_CHECK_THROW(producer.push(nullptr), std::invalid_argument);
+
+    producer.push(std::make_shared<grechin::Circle>(1, grechin::point_t{ static_cast<double>(count), 0 }));
+  }
+
+  BOOST_CHECK_EQUAL(buffer.commit(arr), count + 1);
+  BOOST_CHECK_EQUAL(buffer.getSize(), 0);
+  BOOST_CHECK_EQUAL(buffer.commit(arr), 0);
+  BOOST_REQUIRE_EQUAL(arr.getSize(), count + 1);
+  for (size_t i = 0; i < arr.getSize(); i++)
+  {
+    BOOST_CHECK_EQUAL(arr[i]->getFrameRect().pos.x, i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(multiple_producers_test)
+{
+  const size_t producers = 8;
+  const size_t count = 20000;
+  grechin::IngestBuffer buffer;
+  grechin::CompositeShape arr;
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < producers; i++)
+  {
+    threads.emplace_back([&buffer, i, count]()
+    {
+      grechin::IngestBuffer::Producer producer(buffer);
+      for (size_t j = 0; j < count; j++)
+      {
+        producer.push(std::make_shared<grechin::Circle>(1,
+            grechin::point_t{ static_cast<double>(i), static_cast<double>(j) }));
+      }
+    });
+  }
+  size_t committed = 0;
+  for (size_t i = 0; i < 50; i++)
+  {
+    committed += buffer.commit(arr);
+    std::this_thread::yield();
+  }
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+  committed += buffer.commit(arr);
+
+  BOOST_REQUIRE_EQUAL(committed, producers * count);
+  BOOST_REQUIRE_EQUAL(arr.getSize(), producers * count);
+
+  std::vector<size_t> next(producers, 0);
+  for (size_t i = 0; i < arr.getSize(); i++)
+  {
+    const grechin::point_t pos = arr[i]->getFrameRect().pos;
+    const size_t producer = static_cast<size_t>(pos.x);
+    BOOST_REQUIRE(producer < producers);
+    BOOST_REQUIRE_EQUAL(static_cast<size_t>(pos.y), next[producer]);
+    next[producer]++;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(rejected_shape_test)
+{
+  std::shared_ptr<grechin::CompositeShape> arr = std::make_shared<grechin::CompositeShape>();
+  grechin::IngestBuffer buffer;
+  grechin::IngestBuffer::Producer producer(buffer);
+  producer.push(std::make_shared<grechin::Circle>(1, grechin::point_t{ 0, 0 }));
+  producer.push(arr);
+  producer.push(std::make_shared<grechin::Circle>(1, grechin::point_t{ 2, 0 }));
+  producer.flush();
+
+  BOOST_CHECK_THROW(buffer.commit(*arr), std::invalid_argument);
+  BOOST_CHECK_EQUAL(arr->getSize(), 1);
+  BOOST_CHECK_EQUAL(buffer.getSize(), 1);
+  BOOST_CHECK_EQUAL(buffer.commit(*arr), 1);
+  BOOST_REQUIRE_EQUAL(arr->getSize(), 2);
+  BOOST_CHECK_EQUAL((*arr)[1]->getFrameRect().pos.x, 2);
+
+  std::shared_ptr<grechin::CompositeShape> target = std::make_shared<grechin::CompositeShape>();
+  for (size_t i = 0; i < 3 * grechin::INGEST_CHUNK; i++)
+  {
+    if (i == 10)
+    {
+      producer.push(target);
+    }
+    else
+    {
+      producer.push(std::make_shared<grechin::Circle>(1, grechin::point_t{ static_cast<double>(i), 0 }));
+    }
+  }
+  producer.flush();
+
+  BOOST_CHECK_THROW(buffer.commit(*target), std::invalid_argument);
+  BOOST_CHECK_EQUAL(target->getSize(), 10);
+  BOOST_CHECK_EQUAL(buffer.commit(*target), 3 * grechin::INGEST_CHUNK - 11);
+  BOOST_REQUIRE_EQUAL(target->getSize(), 3 * grechin::INGEST_CHUNK - 1);
+  for (size_t i = 0; i < target->getSize(); i++)
+  {
+    BOOST_CHECK_EQUAL((*target)[i]->getFrameRect().pos.x, static_cast<double>((i < 10) ? i : i + 1));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,130 @@
+#include <sstream>
+#include <string>
+#include <thread>
+#include <boost/test/unit_test.hpp>
+
+#include "circle.hpp"
+#include "composite-shape.hpp"
+#include "instrumentation.hpp"
+#include "base-types.hpp"
+
+BOOST_AUTO_TEST_SUITE(instrumentation_test)
+
+namespace instrumentation = grechin::instrumentation;
+
+const size_t SCALE = static_cast<size_t>(instrumentation::Operation::compositeScale);
+const size_t FRAME = static_cast<size_t>(instrumentation::Operation::circleGetFrameRect);
+
+BOOST_AUTO_TEST_CASE(counters_test)
+{
+  instrumentation::reset();
+  {
+    instrumentation::Scope scope("loader");
+    instrumentation::Call call(instrumentation::Operation::compositeScale);
+    instrumentation::addChildren(3);
+    {
+      instrumentation::Call nested(instrumentation::Operation::circleGetFrameRect);
+      instrumentation::addAllocation(64);
+    }
+    instrumentation::addChildren(2);
+  }
+  instrumentation::addChildren(5);
+
+  const instrumentation::Snapshot snapshot = instrumentation::getSnapshot();
+
+  BOOST_REQUIRE(snapshot.count("loader") == 1);
+  BOOST_CHECK_EQUAL(snapshot.at("loader")[SCALE].calls, 1);
+  BOOST_CHECK_EQUAL(snapshot.at("loader")[SCALE].children, 5);
+  BOOST_CHECK_EQUAL(snapshot.at("loader")[SCALE].allocations, 0);
+  BOOST_CHECK_EQUAL(snapshot.at("loader")[FRAME].calls, 1);
+  BOOST_CHECK_EQUAL(snapshot.at("loader")[FRAME].allocations, 1);
+  BOOST_CHECK_EQUAL(snapshot.at("loader")[FRAME].bytes, 64);
+  BOOST_CHECK(snapshot.at("loader")[SCALE].nanoseconds >= snapshot.at("loader")[FRAME].nanoseconds);
+
+  instrumentation::reset();
+
+  BOOST_CHECK_EQUAL(instrumentation::getSnapshot().at("loader")[SCALE].calls, 0);
+}
+
+BOOST_AUTO_TEST_CASE(thread_test)
+{
+  instrumentation::reset();
+  std::thread worker([]()
+  {
+    instrumentation::Scope scope("worker");
+    for (size_t i = 0; i < 10; i++)
+    {
+      instrumentation::Call call(instrumentation::Operation::compositeScale);
+    }
+  });
+  worker.join();
+  {
+    instrumentation::Scope scope("worker");
+    instrumentation::Call call(instrumentation::Operation::compositeScale);
+  }
+
+  BOOST_CHECK_EQUAL(instrumentation::getSnapshot().at("worker")[SCALE].calls, 11);
+
+  instrumentation::reset();
+
+  BOOST_CHECK_EQUAL(instrumentation::getSnapshot().at("worker")[SCALE].calls, 0);
+}
+
+BOOST_AUTO_TEST_CASE(transient_name_test)
+{
+  instrumentation::reset();
+  char name[] = "first";
+  {
+    instrumentation::Scope scope(name);
+    instrumentation::Call call(instrumentation::Operation::compositeScale);
+  }
+  name[0] = 'F';
+  {
+    instrumentation::Scope scope(name);
+    instrumentation::Call call(instrumentation::Operation::compositeScale);
+  }
+  name[0] = '\0';
+
+  const instrumentation::Snapshot snapshot = instrumentation::getSnapshot();
+  BOOST_CHECK_EQUAL(snapshot.at("first")[SCALE].calls, 1);
+  BOOST_CHECK_EQUAL(snapshot.at("First")[SCALE].calls, 1);
+}
+
+BOOST_AUTO_TEST_CASE(json_test)
+{
+  instrumentation::Snapshot snapshot;
+  snapshot["a\"b"][SCALE] = { 2, 7, 1, 16, 100 };
+  std::ostringstream out;
+  instrumentation::writeJson(out, snapshot);
+
+  BOOST_CHECK_EQUAL(out.str(), "{\"a\\\"b\":{\"composite.scale\":"
+      "{\"calls\":2,\"children\":7,\"allocations\":1,\"bytes\":16,\"nanoseconds\":100}}}");
+  BOOST_CHECK_EQUAL(std::string(instrumentation::getOperationName(instrumentation::Operation::circleGetFrameRect)),
+      "circle.getFrameRect");
+}
+
+#ifdef GRECHIN_INSTRUMENT
+BOOST_AUTO_TEST_CASE(shape_test)
+{
+  grechin::CompositeShape arr;
+  arr.add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 0, 0 }));
+  arr.add(std::make_shared<grechin::Circle>(2, grechin::point_t{ 3, 0 }));
+  instrumentation::reset();
+  {
+    GRECHIN_INSTRUMENT_SCOPE("shapes");
+    arr.move(1, 1);
+    arr.rotate(90);
+    arr.getFrameRect();
+  }
+
+  const instrumentation::CounterTable& table = instrumentation::getSnapshot().at("shapes");
+
+  BOOST_CHECK_EQUAL(table[static_cast<size_t>(instrumentation::Operation::compositeGetFrameRect)].calls, 2);
+  BOOST_CHECK_EQUAL(table[static_cast<size_t>(instrumentation::Operation::compositeGetFrameRect)].children, 2);
+  BOOST_CHECK_EQUAL(table[static_cast<size_t>(instrumentation::Operation::compositeFlush)].children, 2);
+  BOOST_CHECK_EQUAL(table[static_cast<size_t>(instrumentation::Operation::circleRotate)].calls, 2);
+  BOOST_CHECK_EQUAL(table[static_cast<size_t>(instrumentation::Operation::circleMove)].calls, 2);
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
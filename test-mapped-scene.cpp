@@ -0,0 +1,112 @@
+#include <memory>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <utility>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "composite-shape.hpp"
+#include "serialization.hpp"
+#include "mapped-scene.hpp"
+#include "base-types.hpp"
+
+BOOST_AUTO_TEST_SUITE(mapped_scene_test)
+
+const double EPSILON = 0.00001;
+
+struct fixture_t
+{
+  fixture_t() :
+    path((std::filesystem::temp_directory_path() / "grechin-mapped-scene-test.bin").string())
+  {
+    std::shared_ptr<grechin::Circle> shared = std::make_shared<grechin::Circle>(1.5, grechin::point_t{ -4.1, 2.0 });
+    std::shared_ptr<grechin::CompositeShape> nested = std::make_shared<grechin::CompositeShape>();
+    nested->add(shared);
+    nested->add(std::make_shared<grechin::Rectangle>(2.0, 8.0, grechin::point_t{ 0.5, -7.5 }, 120));
+    arr.add(std::make_shared<grechin::Rectangle>(10.1, 6.9, grechin::point_t{ 7.2, 11.1 }, 30));
+    arr.add(nested);
+    arr.add(shared);
+    arr.add(std::make_shared<grechin::Circle>(3.2, grechin::point_t{ 14.6, -12.3 }));
+
+    std::ofstream file(path, std::ios::binary);
+    grechin::serialize(file, arr);
+  }
+  ~fixture_t()
+  {
+    std::remove(path.c_str());
+  }
+  std::string path;
+  grechin::CompositeShape arr;
+};
+
+void checkFrame(const grechin::rectangle_t& lhs, const grechin::rectangle_t& rhs)
+{
+  BOOST_CHECK_CLOSE(lhs.width, rhs.width, EPSILON);
+  BOOST_CHECK_CLOSE(lhs.height, rhs.height, EPSILON);
+  BOOST_CHECK_CLOSE(lhs.pos.x, rhs.pos.x, EPSILON);
+  BOOST_CHECK_CLOSE(lhs.pos.y, rhs.pos.y, EPSILON);
+}
+
+BOOST_FIXTURE_TEST_CASE(query_test, fixture_t)
+{
+  const grechin::MappedScene scene(path);
+
+  BOOST_CHECK_EQUAL(scene.getCircleCount(), 2);
+  BOOST_CHECK_EQUAL(scene.getRectangleCount(), 2);
+  BOOST_CHECK_EQUAL(scene.getCompositeCount(), 2);
+  BOOST_CHECK_CLOSE(scene.getArea(), arr.getArea(), EPSILON);
+  checkFrame(scene.getFrameRect(), arr.getFrameRect());
+
+  const uint64_t root = scene.getRoot();
+
+  BOOST_REQUIRE_EQUAL(scene.getChildCount(root), arr.getSize());
+  for (size_t i = 0; i < arr.getSize(); i++)
+  {
+    const uint64_t child = scene.getChild(root, i);
+
+    BOOST_CHECK_CLOSE(scene.getArea(child), arr[i]->getArea(), EPSILON);
+    checkFrame(scene.getFrameRect(child), arr[i]->getFrameRect());
+  }
+
+  BOOST_CHECK(grechin::getReferenceType(scene.getChild(root, 1)) == grechin::ShapeType::composite);
+  BOOST_CHECK_EQUAL(scene.getChild(scene.getChild(root, 1), 0), scene.getChild(root, 2));
+  BOOST_CHECK_EQUAL(scene.getChildCount(scene.getChild(root, 0)), 0);
+  BOOST_CHECK_THROW(scene.getChild(root, 4), std::out_of_range);
+  BOOST_CHECK_THROW(scene.getArea(grechin::makeReference(grechin::ShapeType::circle, 2)), std::out_of_range);
+}
+
+BOOST_FIXTURE_TEST_CASE(move_test, fixture_t)
+{
+  grechin::MappedScene scene(path);
+  grechin::MappedScene moved(std::move(scene));
+
+  BOOST_CHECK_CLOSE(moved.getArea(), arr.getArea(), EPSILON);
+
+  std::ofstream file(path, std::ios::binary);
+  grechin::serialize(file, *arr[3]);
+  file.close();
+  moved = grechin::MappedScene(path);
+
+  BOOST_CHECK_EQUAL(moved.getCompositeCount(), 0);
+  BOOST_CHECK_CLOSE(moved.getArea(), arr[3]->getArea(), EPSILON);
+  checkFrame(moved.getFrameRect(), arr[3]->getFrameRect());
+}
+
+BOOST_FIXTURE_TEST_CASE(invalid_file_test, fixture_t)
+{
+  BOOST_CHECK_THROW(grechin::MappedScene(path + ".missing"), std::invalid_argument);
+
+  const std::vector<char> buffer = grechin::serialize(arr);
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(buffer.data(), buffer.size() - 8);
+  file.close();
+
+  BOOST_CHECK_THROW(grechin::MappedScene scene(path), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
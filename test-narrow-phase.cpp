@@ -0,0 +1,207 @@
+#include <memory>
+#include <vector>
+#include <random>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "composite-shape.hpp"
+#include "broad-phase.hpp"
+#include "narrow-phase.hpp"
+#include "base-types.hpp"
+
+BOOST_AUTO_TEST_SUITE(narrow_phase_test)
+
+std::vector<grechin::point_t> getCorners(const grechin::Rectangle& rectangle)
+{
+  const grechin::point_t center = rectangle.getFrameRect().pos;
+  const grechin::rotation_t rotation = addition::getRotation(rectangle.getAngle());
+  const double width = rectangle.getWidth() / 2;
+  const double height = rectangle.getHeight() / 2;
+  std::vector<grechin::point_t> corners;
+  for (const grechin::point_t& corner : { grechin::point_t{ -width, -height }, grechin::point_t{ width, -height },
+      grechin::point_t{ width, height }, grechin::point_t{ -width, height } })
+  {
+    corners.push_back({ center.x + corner.x * rotation.cos - corner.y * rotation.sin,
+        center.y + corner.x * rotation.sin + corner.y * rotation.cos });
+  }
+  return corners;
+}
+
+double cross(const grechin::point_t& origin, const grechin::point_t& lhs, const grechin::point_t& rhs)
+{
+  return (lhs.x - origin.x) * (rhs.y - origin.y) - (lhs.y - origin.y) * (rhs.x - origin.x);
+}
+
+bool isInside(const grechin::point_t& point, const std::vector<grechin::point_t>& polygon)
+{
+  for (size_t i = 0; i < polygon.size(); i++)
+  {
+    if (cross(polygon[i], polygon[(i + 1) % polygon.size()], point) <= 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool isCrossed(const std::vector<grechin::point_t>& lhs, const std::vector<grechin::point_t>& rhs)
+{
+  for (size_t i = 0; i < lhs.size(); i++)
+  {
+    const grechin::point_t& a = lhs[i];
+    const grechin::point_t& b = lhs[(i + 1) % lhs.size()];
+    for (size_t j = 0; j < rhs.size(); j++)
+    {
+      const grechin::point_t& c = rhs[j];
+      const grechin::point_t& d = rhs[(j + 1) % rhs.size()];
+      if (cross(a, b, c) * cross(a, b, d) < 0 && cross(c, d, a) * cross(c, d, b) < 0)
+      {
+        return true;
+      }
+    }
+  }
+  return isInside(lhs[0], rhs) || isInside(rhs[0], lhs);
+}
+
+BOOST_AUTO_TEST_CASE(circle_test)
+{
+  const grechin::Circle fir(1, { 0, 0 });
+  const grechin::Circle sec(1, { 1.6, 1.6 });
+  const grechin::Circle third(1.5, { 1.5, 1.0 });
+
+  BOOST_CHECK(addition::isOverlapped(fir.getFrameRect(), sec.getFrameRect()));
+  BOOST_CHECK(!addition::isIntersected(fir, sec));
+  BOOST_CHECK(addition::isIntersected(fir, third));
+  BOOST_CHECK(addition::isIntersected(sec, third));
+}
+
+BOOST_AUTO_TEST_CASE(circle_rectangle_test)
+{
+  const grechin::Rectangle rectangle(4, 2, { 0, 0 });
+  const grechin::Circle corner(1, { 2.8, 1.8 });
+  const grechin::Circle side(1, { 2.5, 0 });
+
+  BOOST_CHECK(addition::isOverlapped(rectangle.getFrameRect(), corner.getFrameRect()));
+  BOOST_CHECK(!addition::isIntersected(rectangle, corner));
+  BOOST_CHECK(!addition::isIntersected(corner, rectangle));
+  BOOST_CHECK(addition::isIntersected(rectangle, side));
+  BOOST_CHECK(addition::isIntersected(side, rectangle));
+
+  const grechin::Rectangle rotated(4, 1, { 0, 0 }, 45);
+  const grechin::Circle outside(0.5, { 1.2, -1.2 });
+  const grechin::Circle inside(0.5, { 1.2, 1.2 });
+
+  BOOST_CHECK(addition::isOverlapped(rotated.getFrameRect(), outside.getFrameRect()));
+  BOOST_CHECK(!addition::isIntersected(rotated, outside));
+  BOOST_CHECK(addition::isIntersected(rotated, inside));
+}
+
+BOOST_AUTO_TEST_CASE(rectangle_test)
+{
+  const grechin::Rectangle fir(4, 1, { 0, 0 }, 45);
+  const grechin::Rectangle parallel(4, 1, { 2, -2 }, 45);
+  const grechin::Rectangle crossing(4, 1, { 0.5, 0 }, -45);
+
+  BOOST_CHECK(addition::isOverlapped(fir.getFrameRect(), parallel.getFrameRect()));
+  BOOST_CHECK(!addition::isIntersected(fir, parallel));
+  BOOST_CHECK(addition::isIntersected(fir, crossing));
+  BOOST_CHECK(addition::isIntersected(parallel, crossing));
+}
+
+BOOST_AUTO_TEST_CASE(random_rectangle_test)
+{
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> size(0.5, 6);
+  std::uniform_real_distribution<double> coordinate(-5, 5);
+  std::uniform_real_distribution<double> angle(0, 180);
+
+  size_t intersected = 0;
+  size_t culled = 0;
+  for (size_t i = 0; i < 2000; i++)
+  {
+    const grechin::Rectangle fir(size(generator), size(generator), { coordinate(generator), coordinate(generator) },
+        angle(generator));
+    const grechin::Rectangle sec(size(generator), size(generator), { coordinate(generator), coordinate(generator) },
+        angle(generator));
+    const bool expected = isCrossed(getCorners(fir), getCorners(sec));
+
+    BOOST_CHECK_EQUAL(addition::isIntersected(fir, sec), expected);
+    BOOST_CHECK_EQUAL(addition::isIntersected(sec, fir), expected);
+
+    intersected += expected;
+    culled += !expected && addition::isOverlapped(fir.getFrameRect(), sec.getFrameRect());
+  }
+
+  BOOST_CHECK(intersected != 0);
+  BOOST_CHECK(culled != 0);
+}
+
+BOOST_AUTO_TEST_CASE(batch_test)
+{
+  std::mt19937 generator(13);
+  std::uniform_real_distribution<double> size(0.5, 6);
+  std::uniform_real_distribution<double> coordinate(-40, 40);
+  std::uniform_real_distribution<double> angle(0, 360);
+
+  grechin::CompositeShape arr;
+  for (size_t i = 0; i < 600; i++)
+  {
+    const grechin::point_t center = { coordinate(generator), coordinate(generator) };
+    if (i % 2 == 0)
+    {
+      arr.add(std::make_shared<grechin::Circle>(size(generator) / 2, center));
+    }
+    else
+    {
+      arr.add(std::make_shared<grechin::Rectangle>(size(generator), size(generator), center, angle(generator)));
+    }
+  }
+
+  const std::vector<grechin::index_pair_t> candidates = addition::findOverlapping(arr);
+  std::vector<grechin::index_pair_t> expected;
+  for (const grechin::index_pair_t& pair : candidates)
+  {
+    if (addition::isIntersected(*arr[pair.first], *arr[pair.second]))
+    {
+      expected.push_back(pair);
+    }
+  }
+
+  grechin::NarrowPhase narrow;
+  const std::vector<grechin::index_pair_t>& result = narrow.update(arr, candidates);
+
+  BOOST_CHECK(!expected.empty());
+  BOOST_CHECK(expected.size() < candidates.size());
+  BOOST_CHECK(result == expected);
+  BOOST_CHECK(narrow.getPairs() == expected);
+  BOOST_CHECK(addition::findIntersecting(arr) == expected);
+
+  narrow.reset();
+
+  BOOST_CHECK(narrow.getPairs().empty());
+}
+
+BOOST_AUTO_TEST_CASE(composite_child_test)
+{
+  std::shared_ptr<grechin::CompositeShape> nested = std::make_shared<grechin::CompositeShape>();
+  nested->add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 0, 0 }));
+  nested->add(std::make_shared<grechin::Circle>(1, grechin::point_t{ 4, 4 }));
+
+  grechin::CompositeShape arr;
+  arr.add(nested);
+  arr.add(std::make_shared<grechin::Circle>(0.5, grechin::point_t{ 2, 2 }));
+  arr.add(std::make_shared<grechin::Circle>(0.5, grechin::point_t{ 5.4, 5.4 }));
+
+  const std::vector<grechin::index_pair_t> pairs = addition::findIntersecting(arr);
+
+  BOOST_REQUIRE_EQUAL(pairs.size(), 1);
+  BOOST_CHECK(pairs[0] == grechin::index_pair_t(0, 1));
+
+  grechin::NarrowPhase narrow;
+
+  BOOST_CHECK_THROW(narrow.update(arr, { { 0, 3 } }), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,187 @@
+#define _USE_MATH_DEFINES
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <random>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "composite-shape.hpp"
+#include "raster.hpp"
+#include "base-types.hpp"
+
+BOOST_AUTO_TEST_SUITE(raster_test)
+
+const double EPSILON = 0.00001;
+
+bool isInside(const grechin::Shape& shape, const double x, const double y)
+{
+  const grechin::point_t center = shape.getFrameRect().pos;
+  const double dx = x - center.x;
+  const double dy = y - center.y;
+  const grechin::Circle* circle = dynamic_cast<const grechin::Circle*>(&shape);
+  if (circle != nullptr)
+  {
+    return dx * dx + dy * dy <= circle->getRadius() * circle->getRadius();
+  }
+  const grechin::Rectangle& rectangle = dynamic_cast<const grechin::Rectangle&>(shape);
+  const double angle = rectangle.getAngle() * M_PI / 180;
+  return fabs(dx * std::cos(angle) + dy * std::sin(angle)) <= rectangle.getWidth() / 2
+      && fabs(dy * std::cos(angle) - dx * std::sin(angle)) <= rectangle.getHeight() / 2;
+}
+
+double getCoverage(const grechin::bitmap_t& bitmap)
+{
+  double sum = 0;
+  for (const uint8_t pixel : bitmap.pixels)
+  {
+    sum += pixel;
+  }
+  return sum / 255;
+}
+
+BOOST_AUTO_TEST_CASE(coverage_test)
+{
+  const grechin::Rectangle rectangle(4, 2, { 5, 5 });
+  const grechin::bitmap_t bitmap = grechin::rasterize(rectangle, { 10, 10, { 5, 5 } }, 10, 10, 1,
+      grechin::parallel::getDefaultPolicy());
+
+  BOOST_REQUIRE_EQUAL(bitmap.width, 10);
+  BOOST_REQUIRE_EQUAL(bitmap.height, 10);
+  BOOST_REQUIRE_EQUAL(bitmap.pixels.size(), 100);
+  for (size_t y = 0; y < 10; y++)
+  {
+    for (size_t x = 0; x < 10; x++)
+    {
+      const bool inside = x >= 3 && x < 7 && y >= 4 && y < 6;
+      BOOST_CHECK_EQUAL(bitmap.pixels[y * 10 + x], inside ? 255 : 0);
+    }
+  }
+
+  const grechin::Rectangle top(10, 1, { 5, 9.5 });
+  const grechin::bitmap_t row = grechin::rasterize(top, { 10, 10, { 5, 5 } }, 10, 10, 1,
+      grechin::parallel::getDefaultPolicy());
+
+  BOOST_CHECK_EQUAL(row.pixels[0], 255);
+  BOOST_CHECK_EQUAL(row.pixels[99], 0);
+  BOOST_CHECK_CLOSE(getCoverage(row), 10, EPSILON);
+}
+
+BOOST_AUTO_TEST_CASE(anti_aliasing_test)
+{
+  grechin::CompositeShape arr;
+  arr.add(std::make_shared<grechin::Circle>(3, grechin::point_t{ 0, 0 }));
+  arr.add(std::make_shared<grechin::Rectangle>(4, 4, grechin::point_t{ 2.5, 1 }, 30));
+  const grechin::rectangle_t viewport = { 16, 12, { 0, 0 } };
+  const double pixel = 16.0 / 400;
+
+  const grechin::bitmap_t bitmap = grechin::rasterize(arr, viewport, 400, 300, grechin::RASTER_SAMPLES,
+      grechin::parallel::getDefaultPolicy());
+  const double area = getCoverage(bitmap) * pixel * pixel;
+
+  BOOST_CHECK_CLOSE(area, arr.getUnionArea(), 0.1);
+
+  const grechin::bitmap_t odd = grechin::rasterize(arr, viewport, 400, 300, 3,
+      grechin::parallel::getDefaultPolicy());
+
+  BOOST_CHECK_CLOSE(getCoverage(odd) * pixel * pixel, arr.getUnionArea(), 0.1);
+
+  size_t partial = 0;
+  for (const uint8_t value : bitmap.pixels)
+  {
+    partial += value != 0 && value != 255;
+  }
+
+  BOOST_CHECK(partial != 0);
+}
+
+BOOST_AUTO_TEST_CASE(brute_force_test)
+{
+  std::mt19937 generator(23);
+  std::uniform_real_distribution<double> size(0.5, 6);
+  std::uniform_real_distribution<double> coordinate(-25, 25);
+  std::uniform_real_distribution<double> angle(0, 180);
+
+  std::shared_ptr<grechin::CompositeShape> nested = std::make_shared<grechin::CompositeShape>();
+  grechin::CompositeShape arr;
+  std::vector<std::shared_ptr<grechin::Shape>> leaves;
+  for (size_t i = 0; i < 300; i++)
+  {
+    const grechin::point_t center = { coordinate(generator), coordinate(generator) };
+    std::shared_ptr<grechin::Shape> shape;
+    if (i % 2 == 0)
+    {
+      shape = std::make_shared<grechin::Circle>(size(generator) / 2, center);
+    }
+    else
+    {
+      shape = std::make_shared<grechin::Rectangle>(size(generator), size(generator), center, angle(generator));
+    }
+    leaves.push_back(shape);
+    if (i % 3 == 0)
+    {
+      nested->add(shape);
+    }
+    else
+    {
+      arr.add(shape);
+    }
+  }
+  arr.add(nested);
+
+  const grechin::rectangle_t viewport = { 60, 50, { 2, -1 } };
+  const size_t width = 150;
+  const size_t height = 130;
+  const grechin::bitmap_t bitmap = grechin::rasterize(arr, viewport, width, height, 1,
+      grechin::parallel::getDefaultPolicy());
+
+  size_t mismatches = 0;
+  size_t covered = 0;
+  for (size_t y = 0; y < height; y++)
+  {
+    for (size_t x = 0; x < width; x++)
+    {
+      const double px = viewport.pos.x - viewport.width / 2 + (x + 0.5) * viewport.width / width;
+      const double py = viewport.pos.y + viewport.height / 2 - (y + 0.5) * viewport.height / height;
+      bool inside = false;
+      for (const std::shared_ptr<grechin::Shape>& shape : leaves)
+      {
+        inside = inside || isInside(*shape, px, py);
+      }
+      mismatches += (bitmap.pixels[y * width + x] == 255) != inside;
+      covered += inside;
+    }
+  }
+
+  BOOST_CHECK_EQUAL(mismatches, 0);
+  BOOST_CHECK(covered != 0);
+  BOOST_CHECK(covered < width * height);
+
+  grechin::execution_policy_t policy = grechin::parallel::getDefaultPolicy();
+  policy.parallel = true;
+  policy.threshold = 0;
+  policy.threads = 4;
+  const grechin::bitmap_t parallel = grechin::rasterize(arr, viewport, width, height, 1, policy);
+
+  BOOST_CHECK(parallel.pixels == bitmap.pixels);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_arguments_test)
+{
+  const grechin::Circle circle(1, { 0, 0 });
+  const grechin::execution_policy_t policy = grechin::parallel::getDefaultPolicy();
+
+  BOOST_CHECK_THROW(grechin::rasterize(circle, { 0, 2, { 0, 0 } }, 10, 10, 1, policy), std::invalid_argument);
+  BOOST_CHECK_THROW(grechin::rasterize(circle, { 2, 2, { 0, 0 } }, 0, 10, 1, policy), std::invalid_argument);
+  BOOST_CHECK_THROW(grechin::rasterize(circle, { 2, 2, { 0, 0 } }, 10, 10, 0, policy), std::invalid_argument);
+
+  const grechin::bitmap_t empty = grechin::rasterize(std::vector<grechin::collider_t>(), { 2, 2, { 0, 0 } }, 3, 2,
+      grechin::RASTER_SAMPLES, policy);
+
+  BOOST_CHECK(empty.pixels == std::vector<uint8_t>(6, 0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
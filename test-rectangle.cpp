@@ -20,6 +20,9 @@ BOOST_AUTO_TEST_CASE(valid_test)
 {
   grechin::Rectangle rectangle(WIDTH, HEIGHT, CENTER);
 
+  BOOST_CHECK_EQUAL(rectangle.getWidth(), WIDTH);
+  BOOST_CHECK_EQUAL(rectangle.getHeight(), HEIGHT);
+  BOOST_CHECK_EQUAL(rectangle.getAngle(), 0);
   BOOST_CHECK_CLOSE(rectangle.getArea(), AREA, EPSILON);
 
   BOOST_CHECK_EQUAL(rectangle.getFrameRect().width, WIDTH);
@@ -235,6 +238,32 @@ BOOST_AUTO_TEST_CASE(rotate_negative_angle_test)
   BOOST_CHECK_CLOSE(rectangle.getFrameRect().height, newHeight, EPSILON);
 }
 
+BOOST_AUTO_TEST_CASE(rotate_exact_right_angle_test)
+{
+  grechin::Rectangle rectangle(WIDTH, HEIGHT, CENTER, -90);
+
+  BOOST_CHECK_EQUAL(rectangle.getFrameRect().width, HEIGHT);
+  BOOST_CHECK_EQUAL(rectangle.getFrameRect().height, WIDTH);
+
+  rectangle.rotate(450);
+
+  BOOST_CHECK_EQUAL(rectangle.getFrameRect().width, WIDTH);
+  BOOST_CHECK_EQUAL(rectangle.getFrameRect().height, HEIGHT);
+
+  const grechin::rotation_t rotation = addition::getRotation(270);
+
+  BOOST_CHECK_EQUAL(rotation.cos, 0);
+  BOOST_CHECK_EQUAL(rotation.sin, -1);
+
+  grechin::point_t point = { 3, 1 };
+  addition::revolve(point, { 1, 1 }, addition::getRotation(32));
+  grechin::point_t expected = { 3, 1 };
+  addition::revolve(expected, { 1, 1 }, 32);
+
+  BOOST_CHECK_EQUAL(point.x, expected.x);
+  BOOST_CHECK_EQUAL(point.y, expected.y);
+}
+
 BOOST_AUTO_TEST_CASE(exception_constructor_test)
 {
   BOOST_CHECK_THROW(grechin::Rectangle rectangle(0, HEIGHT, CENTER), std::invalid_argument);
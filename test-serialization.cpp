@@ -0,0 +1,149 @@
+#include <memory>
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "composite-shape.hpp"
+#include "serialization.hpp"
+#include "base-types.hpp"
+
+BOOST_AUTO_TEST_SUITE(serialization_test)
+
+const double EPSILON = 0.00001;
+
+struct fixture_t
+{
+  fixture_t() :
+    shared(std::make_shared<grechin::Circle>(1.5, grechin::point_t{ -4.1, 2.0 })),
+    nested(std::make_shared<grechin::CompositeShape>())
+  {
+    nested->add(shared);
+    nested->add(std::make_shared<grechin::Rectangle>(2.0, 8.0, grechin::point_t{ 0.5, -7.5 }, 120));
+    arr.add(std::make_shared<grechin::Rectangle>(10.1, 6.9, grechin::point_t{ 7.2, 11.1 }, 30));
+    arr.add(nested);
+    arr.add(shared);
+    arr.add(nested);
+  }
+  std::shared_ptr<grechin::Circle> shared;
+  std::shared_ptr<grechin::CompositeShape> nested;
+  grechin::CompositeShape arr;
+};
+
+void checkFrame(const grechin::rectangle_t& lhs, const grechin::rectangle_t& rhs)
+{
+  BOOST_CHECK_CLOSE(lhs.width, rhs.width, EPSILON);
+  BOOST_CHECK_CLOSE(lhs.height, rhs.height, EPSILON);
+  BOOST_CHECK_CLOSE(lhs.pos.x, rhs.pos.x, EPSILON);
+  BOOST_CHECK_CLOSE(lhs.pos.y, rhs.pos.y, EPSILON);
+}
+
+BOOST_FIXTURE_TEST_CASE(buffer_test, fixture_t)
+{
+  const std::vector<char> buffer = grechin::serialize(arr);
+
+  BOOST_CHECK_EQUAL(buffer.size(), grechin::SERIALIZATION_HEADER_SIZE + 8 * (3 + 5 * 2 + 3 + 6));
+
+  const std::shared_ptr<grechin::Shape> shape = grechin::deserialize(buffer.data(), buffer.size());
+  const std::shared_ptr<grechin::CompositeShape> result = std::dynamic_pointer_cast<grechin::CompositeShape>(shape);
+
+  BOOST_REQUIRE(result != nullptr);
+  BOOST_REQUIRE_EQUAL(result->getSize(), 4);
+  BOOST_CHECK_CLOSE(result->getArea(), arr.getArea(), EPSILON);
+  checkFrame(result->getFrameRect(), arr.getFrameRect());
+  BOOST_CHECK_EQUAL((*result)[1], (*result)[3]);
+
+  const std::shared_ptr<grechin::CompositeShape> resultNested =
+      std::dynamic_pointer_cast<grechin::CompositeShape>((*result)[1]);
+
+  BOOST_REQUIRE(resultNested != nullptr);
+  BOOST_CHECK_EQUAL((*resultNested)[0], (*result)[2]);
+
+  const std::shared_ptr<grechin::Rectangle> rectangle = std::dynamic_pointer_cast<grechin::Rectangle>((*result)[0]);
+
+  BOOST_REQUIRE(rectangle != nullptr);
+  BOOST_CHECK_CLOSE(rectangle->getAngle(), 30, EPSILON);
+  checkFrame(rectangle->getFrameRect(), arr[0]->getFrameRect());
+}
+
+BOOST_FIXTURE_TEST_CASE(stream_test, fixture_t)
+{
+  std::stringstream stream;
+  grechin::serialize(stream, arr);
+  grechin::serialize(stream, *shared);
+
+  const std::shared_ptr<grechin::Shape> composite = grechin::deserialize(stream);
+  const std::shared_ptr<grechin::Shape> circle = grechin::deserialize(stream);
+
+  checkFrame(composite->getFrameRect(), arr.getFrameRect());
+  BOOST_REQUIRE(std::dynamic_pointer_cast<grechin::Circle>(circle) != nullptr);
+  BOOST_CHECK_CLOSE(circle->getArea(), shared->getArea(), EPSILON);
+  checkFrame(circle->getFrameRect(), shared->getFrameRect());
+}
+
+BOOST_FIXTURE_TEST_CASE(invalid_data_test, fixture_t)
+{
+  std::vector<char> buffer = grechin::serialize(arr);
+
+  BOOST_CHECK_THROW(grechin::deserialize(buffer.data(), buffer.size() - 1), std::invalid_argument);
+  BOOST_CHECK_THROW(grechin::deserialize(buffer.data(), 10), std::invalid_argument);
+
+  buffer[buffer.size() - 8] = 0x7f;
+
+  BOOST_CHECK_THROW(grechin::deserialize(buffer.data(), buffer.size()), std::invalid_argument);
+
+  buffer[0] = 'X';
+
+  BOOST_CHECK_THROW(grechin::deserialize(buffer.data(), buffer.size()), std::invalid_argument);
+
+  std::stringstream stream;
+  stream.write(buffer.data() + 1, buffer.size() / 2);
+
+  BOOST_CHECK_THROW(grechin::deserialize(stream), std::invalid_argument);
+}
+
+BOOST_FIXTURE_TEST_CASE(invalid_offsets_test, fixture_t)
+{
+  std::vector<char> buffer = grechin::serialize(arr);
+  const size_t offsets = grechin::SERIALIZATION_HEADER_SIZE + 8 * (3 + 5 * 2);
+
+  BOOST_REQUIRE_EQUAL(buffer[offsets + 16], 6);
+
+  std::fill(buffer.begin() + offsets + 8, buffer.begin() + offsets + 16, 0);
+  std::fill(buffer.begin() + offsets + 24, buffer.end(), 0);
+  buffer[offsets + 8] = static_cast<char>(0xe8);
+  buffer[offsets + 9] = 0x03;
+
+  BOOST_CHECK_THROW(grechin::deserialize(buffer.data(), buffer.size()), std::invalid_argument);
+}
+
+BOOST_FIXTURE_TEST_CASE(cycle_test, fixture_t)
+{
+  std::shared_ptr<grechin::CompositeShape> outer = std::make_shared<grechin::CompositeShape>(arr);
+  nested->add(outer);
+
+  BOOST_CHECK_THROW(grechin::serialize(arr), std::logic_error);
+
+  nested->remove(2);
+
+  BOOST_CHECK_NO_THROW(grechin::serialize(arr));
+}
+
+BOOST_AUTO_TEST_CASE(unsupported_shape_test)
+{
+  struct shape_t : public grechin::Circle
+  {
+    shape_t() :
+      grechin::Circle(1, { 0, 0 })
+    {}
+  };
+  grechin::CompositeShape arr;
+  arr.add(std::make_shared<shape_t>());
+
+  BOOST_CHECK_THROW(grechin::serialize(arr), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,119 @@
+#define _USE_MATH_DEFINES
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "composite-shape.hpp"
+#include "shape-store.hpp"
+#include "base-types.hpp"
+
+BOOST_AUTO_TEST_SUITE(shape_store_test)
+
+const double EPSILON = 0.00001;
+
+struct fixture_t
+{
+  fixture_t()
+  {
+    arr.add(std::make_shared<grechin::Rectangle>(10.1, 6.9, grechin::point_t{ 7.2, 11.1 }, 30));
+    arr.add(std::make_shared<grechin::Circle>(3.2, grechin::point_t{ 14.6, -12.3 }));
+
+    std::shared_ptr<grechin::CompositeShape> nested = std::make_shared<grechin::CompositeShape>();
+    nested->add(std::make_shared<grechin::Circle>(1.5, grechin::point_t{ -4.1, 2.0 }));
+    nested->add(std::make_shared<grechin::Rectangle>(2.0, 8.0, grechin::point_t{ 0.5, -7.5 }, 120));
+    arr.add(nested);
+  }
+  grechin::CompositeShape arr;
+};
+
+void checkFrame(const grechin::rectangle_t& lhs, const grechin::rectangle_t& rhs)
+{
+  BOOST_CHECK_CLOSE(lhs.width, rhs.width, EPSILON);
+  BOOST_CHECK_CLOSE(lhs.height, rhs.height, EPSILON);
+  BOOST_CHECK_CLOSE(lhs.pos.x, rhs.pos.x, EPSILON);
+  BOOST_CHECK_CLOSE(lhs.pos.y, rhs.pos.y, EPSILON);
+}
+
+BOOST_FIXTURE_TEST_CASE(import_test, fixture_t)
+{
+  grechin::ShapeStore store(arr);
+
+  BOOST_CHECK_EQUAL(store.getCircleCount(), 2);
+  BOOST_CHECK_EQUAL(store.getRectangleCount(), 2);
+  BOOST_CHECK_EQUAL(store.getSize(), 4);
+  BOOST_CHECK_CLOSE(store.totalArea(), arr.getArea(), EPSILON);
+  checkFrame(store.frameRect(), arr.getFrameRect());
+}
+
+BOOST_FIXTURE_TEST_CASE(export_test, fixture_t)
+{
+  grechin::ShapeStore store(arr);
+  grechin::CompositeShape exported = store.exportShapes();
+
+  BOOST_CHECK_EQUAL(exported.getSize(), 4);
+  BOOST_CHECK_CLOSE(exported.getArea(), arr.getArea(), EPSILON);
+  checkFrame(exported.getFrameRect(), arr.getFrameRect());
+}
+
+BOOST_FIXTURE_TEST_CASE(translate_test, fixture_t)
+{
+  grechin::ShapeStore store(arr);
+
+  store.translate(6.3, -3.4);
+  arr.move(6.3, -3.4);
+
+  checkFrame(store.frameRect(), arr.getFrameRect());
+}
+
+BOOST_FIXTURE_TEST_CASE(scale_test, fixture_t)
+{
+  grechin::ShapeStore store(arr);
+  const grechin::point_t center = arr.getFrameRect().pos;
+
+  store.scaleAbout(center, 2.5);
+  arr.scale(2.5);
+
+  BOOST_CHECK_CLOSE(store.totalArea(), arr.getArea(), EPSILON);
+  checkFrame(store.frameRect(), arr.getFrameRect());
+}
+
+BOOST_AUTO_TEST_CASE(rotate_test)
+{
+  grechin::CompositeShape arr;
+  arr.add(std::make_shared<grechin::Rectangle>(10.1, 6.9, grechin::point_t{ 7.2, 11.1 }, 30));
+  arr.add(std::make_shared<grechin::Circle>(3.2, grechin::point_t{ 14.6, -12.3 }));
+
+  grechin::ShapeStore store(arr);
+  const grechin::point_t center = arr.getFrameRect().pos;
+
+  store.rotateAbout(center, 75);
+  arr.rotate(75);
+
+  BOOST_CHECK_CLOSE(store.totalArea(), arr.getArea(), EPSILON);
+  checkFrame(store.frameRect(), arr.getFrameRect());
+}
+
+BOOST_AUTO_TEST_CASE(empty_test)
+{
+  grechin::ShapeStore store;
+
+  BOOST_CHECK_EQUAL(store.getSize(), 0);
+  BOOST_CHECK_EQUAL(store.totalArea(), 0);
+  BOOST_CHECK_EQUAL(store.frameRect().width, 0);
+  BOOST_CHECK_EQUAL(store.frameRect().height, 0);
+}
+
+BOOST_AUTO_TEST_CASE(exception_test)
+{
+  grechin::ShapeStore store;
+
+  BOOST_CHECK_THROW(store.addCircle(0, { 1, 1 }), std::invalid_argument);
+  BOOST_CHECK_THROW(store.addRectangle(1, -1, { 1, 1 }), std::invalid_argument);
+  BOOST_CHECK_THROW(store.scaleAbout({ 0, 0 }, 0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
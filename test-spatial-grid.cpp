@@ -0,0 +1,142 @@
+#include <cmath>
+#include <vector>
+#include <random>
+#include <utility>
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+
+#include "spatial-grid.hpp"
+#include "base-types.hpp"
+
+BOOST_AUTO_TEST_SUITE(spatial_grid_test)
+
+const size_t COUNT = 2000;
+
+struct fixture_t
+{
+  fixture_t()
+  {
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> size(0.5, 10);
+    std::uniform_real_distribution<double> coordinate(-500, 500);
+
+    for (size_t i = 0; i < COUNT; i++)
+    {
+      frames.push_back({ size(generator), size(generator), { coordinate(generator), coordinate(generator) } });
+    }
+    frames.push_back({ 900, 20, { 0, 0 } });
+    grid.build(frames);
+  }
+
+  std::vector<size_t> overlapping(const grechin::rectangle_t& area, const grechin::point_t& offset) const
+  {
+    std::vector<size_t> result;
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+      const grechin::rectangle_t frame = { frames[i].width, frames[i].height,
+          { frames[i].pos.x + offset.x, frames[i].pos.y + offset.y } };
+      if (addition::isOverlapped(frame, area))
+      {
+        result.push_back(i);
+      }
+    }
+    return result;
+  }
+
+  std::vector<grechin::rectangle_t> frames;
+  grechin::SpatialGrid grid;
+};
+
+double getDistance(const grechin::rectangle_t& frame, const grechin::point_t& point)
+{
+  const double dx = std::max(std::fabs(point.x - frame.pos.x) - frame.width / 2, 0.0);
+  const double dy = std::max(std::fabs(point.y - frame.pos.y) - frame.height / 2, 0.0);
+  return std::hypot(dx, dy);
+}
+
+BOOST_FIXTURE_TEST_CASE(query_overlapping_test, fixture_t)
+{
+  BOOST_CHECK_EQUAL(grid.getSize(), COUNT + 1);
+
+  const grechin::rectangle_t areas[] = {
+    { 30, 40, { 12, -80 } },
+    { 2, 2, { 400, 400 } },
+    { 5000, 5000, { 0, 0 } },
+    { 10, 10, { 3000, 3000 } }
+  };
+  for (const grechin::rectangle_t& area : areas)
+  {
+    const std::vector<size_t> expected = overlapping(area, { 0, 0 });
+    const std::vector<size_t> result = grid.queryOverlapping(area);
+    BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), expected.begin(), expected.end());
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(translate_test, fixture_t)
+{
+  grid.translate(37.5, -12.25);
+
+  const grechin::rectangle_t area = { 60, 25, { -100, 40 } };
+  const std::vector<size_t> expected = overlapping(area, { 37.5, -12.25 });
+  const std::vector<size_t> result = grid.queryOverlapping(area);
+
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), expected.begin(), expected.end());
+}
+
+BOOST_FIXTURE_TEST_CASE(query_point_test, fixture_t)
+{
+  const grechin::point_t point = frames[17].pos;
+  std::vector<size_t> expected;
+  for (size_t i = 0; i < frames.size(); i++)
+  {
+    if (std::fabs(point.x - frames[i].pos.x) <= frames[i].width / 2
+        && std::fabs(point.y - frames[i].pos.y) <= frames[i].height / 2)
+    {
+      expected.push_back(i);
+    }
+  }
+  const std::vector<size_t> result = grid.queryPoint(point);
+
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), expected.begin(), expected.end());
+  BOOST_CHECK(std::find(result.begin(), result.end(), 17) != result.end());
+}
+
+BOOST_FIXTURE_TEST_CASE(nearest_test, fixture_t)
+{
+  const grechin::point_t points[] = { { 3.3, 250 }, { -480, -490 }, { 2000, -3000 } };
+  for (const grechin::point_t& point : points)
+  {
+    std::vector<std::pair<double, size_t>> distances;
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+      distances.emplace_back(getDistance(frames[i], point), i);
+    }
+    std::sort(distances.begin(), distances.end());
+
+    const std::vector<size_t> result = grid.nearest(point, 10);
+
+    BOOST_REQUIRE_EQUAL(result.size(), 10);
+    for (size_t i = 0; i < result.size(); i++)
+    {
+      BOOST_CHECK_EQUAL(result[i], distances[i].second);
+    }
+  }
+
+  BOOST_CHECK_EQUAL(grid.nearest({ 0, 0 }, COUNT * 2).size(), COUNT + 1);
+  BOOST_CHECK(grid.nearest({ 0, 0 }, 0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(empty_test)
+{
+  grechin::SpatialGrid grid;
+
+  BOOST_CHECK(grid.queryOverlapping({ 1, 1, { 0, 0 } }).empty());
+  BOOST_CHECK(grid.queryPoint({ 0, 0 }).empty());
+  BOOST_CHECK(grid.nearest({ 0, 0 }, 3).empty());
+
+  grid.insert(0, { 2, 2, { 5, 5 } });
+
+  BOOST_CHECK_EQUAL(grid.queryPoint({ 5.5, 4.5 }).size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
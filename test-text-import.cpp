@@ -0,0 +1,87 @@
+#define _USE_MATH_DEFINES
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <sstream>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "composite-shape.hpp"
+#include "shape-store.hpp"
+#include "text-import.hpp"
+#include "base-types.hpp"
+
+BOOST_AUTO_TEST_SUITE(text_import_test)
+
+const double EPSILON = 0.00001;
+
+void checkError(const std::string& text, const std::string& message)
+{
+  std::istringstream in(text);
+  grechin::ShapeStore store;
+  try
+  {
+    grechin::importText(in, store);
+    BOOST_ERROR("Expected std::invalid_argument for: " + text);
+  }
+  catch (const std::invalid_argument& ex)
+  {
+    BOOST_CHECK_EQUAL(ex.what(), message);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(composite_test)
+{
+  std::istringstream in("CIRCLE 3.2 14.6 -12.3\n\n  RECTANGLE\t10.1 6.9 7.2 11.1 30\r\nRECTANGLE 2 8 0.5 -7.5");
+  grechin::CompositeShape composite;
+
+  BOOST_CHECK_EQUAL(grechin::importText(in, composite), 3);
+  BOOST_REQUIRE_EQUAL(composite.getSize(), 3);
+
+  const std::shared_ptr<grechin::Circle> circle = std::dynamic_pointer_cast<grechin::Circle>(composite[0]);
+  const std::shared_ptr<grechin::Rectangle> rectangle = std::dynamic_pointer_cast<grechin::Rectangle>(composite[1]);
+
+  BOOST_REQUIRE(circle != nullptr);
+  BOOST_REQUIRE(rectangle != nullptr);
+  BOOST_CHECK_CLOSE(circle->getRadius(), 3.2, EPSILON);
+  BOOST_CHECK_CLOSE(circle->getFrameRect().pos.y, -12.3, EPSILON);
+  BOOST_CHECK_CLOSE(rectangle->getAngle(), 30, EPSILON);
+  BOOST_CHECK_CLOSE(rectangle->getFrameRect().pos.x, 7.2, EPSILON);
+  BOOST_CHECK_CLOSE(composite[2]->getArea(), 16, EPSILON);
+}
+
+BOOST_AUTO_TEST_CASE(chunk_boundary_test)
+{
+  const size_t count = 3 * grechin::TEXT_IMPORT_CHUNK_SIZE / 16;
+  std::string text;
+  for (size_t i = 0; i < count; i++)
+  {
+    text += (i % 2 == 0) ? "CIRCLE 1 " + std::to_string(i) + " 2\n" : "RECTANGLE 2 3 -1 " + std::to_string(i) + "\n";
+  }
+  std::istringstream in(text);
+  grechin::ShapeStore store;
+
+  BOOST_CHECK_EQUAL(grechin::importText(in, store), count);
+  BOOST_CHECK_EQUAL(store.getCircleCount(), count / 2);
+  BOOST_CHECK_EQUAL(store.getRectangleCount(), count / 2);
+  BOOST_CHECK_CLOSE(store.totalArea(), count / 2 * (M_PI + 6), EPSILON);
+  BOOST_CHECK_CLOSE(store.frameRect().height, count + 1, EPSILON);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_text_test)
+{
+  checkError("CIRCLE 1 2 3\nSQUARE 1 2 3\n", "Line 2: Unknown shape type");
+  checkError("\n\nCIRCLE -1 2 3", "Line 3: Radius must be > 0");
+  checkError("RECTANGLE 1 0 2 3\n", "Line 1: Width and height must be > 0");
+  checkError("CIRCLE 1 2\n", "Line 1: CIRCLE expects radius, x and y");
+  checkError("RECTANGLE 1 2 3 4 5 6\n", "Line 1: Too many values");
+  checkError("CIRCLE 1 2 3x\n", "Line 1: Invalid number");
+  checkError("CIRCLE 1,5 2 3\n", "Line 1: Invalid number");
+  checkError("CIRCLE nan 2 3\n", "Line 1: Invalid number");
+  checkError("CIRCLE 1 2 3\n" + std::string(grechin::TEXT_IMPORT_CHUNK_SIZE, ' '), "Line 2: Line is too long");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,128 @@
+#define _USE_MATH_DEFINES
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <random>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "composite-shape.hpp"
+#include "union-area.hpp"
+#include "base-types.hpp"
+
+BOOST_AUTO_TEST_SUITE(union_area_test)
+
+const double EPSILON = 0.00001;
+
+BOOST_AUTO_TEST_CASE(single_shape_test)
+{
+  grechin::CompositeShape arr;
+
+  BOOST_CHECK_EQUAL(arr.getUnionArea(), 0);
+
+  arr.add(std::make_shared<grechin::Circle>(2.5, grechin::point_t{ 1, -3 }));
+
+  BOOST_CHECK_CLOSE(arr.getUnionArea(), M_PI * 2.5 * 2.5, EPSILON);
+
+  arr.remove(0);
+  arr.add(std::make_shared<grechin::Rectangle>(3, 5, grechin::point_t{ 4, 1 }, 30));
+
+  BOOST_CHECK_CLOSE(arr.getUnionArea(), 15, EPSILON);
+}
+
+BOOST_AUTO_TEST_CASE(overlap_test)
+{
+  grechin::CompositeShape arr;
+  arr.add(std::make_shared<grechin::Rectangle>(2, 2, grechin::point_t{ 0, 0 }));
+  arr.add(std::make_shared<grechin::Rectangle>(2, 2, grechin::point_t{ 0, 0 }, 45));
+
+  BOOST_CHECK_CLOSE(arr.getUnionArea(), 8 - 8 * (std::sqrt(2) - 1), EPSILON);
+
+  arr.add(std::make_shared<grechin::Rectangle>(2, 2, grechin::point_t{ 0, 0 }));
+  arr.add(std::make_shared<grechin::Circle>(0.5, grechin::point_t{ 0.2, -0.1 }));
+
+  BOOST_CHECK_CLOSE(arr.getUnionArea(), 8 - 8 * (std::sqrt(2) - 1), EPSILON);
+  BOOST_CHECK_CLOSE(arr.getArea(), 12 + M_PI * 0.25, EPSILON);
+
+  const double radius = 1.5;
+  const double distance = 2;
+  grechin::CompositeShape circles;
+  circles.add(std::make_shared<grechin::Circle>(radius, grechin::point_t{ 0, 0 }));
+  circles.add(std::make_shared<grechin::Circle>(radius, grechin::point_t{ distance, 0 }));
+  const double lens = 2 * radius * radius * std::acos(distance / (2 * radius))
+      - distance / 2 * std::sqrt(4 * radius * radius - distance * distance);
+
+  BOOST_CHECK_CLOSE(circles.getUnionArea(), 2 * M_PI * radius * radius - lens, EPSILON);
+}
+
+BOOST_AUTO_TEST_CASE(error_bound_test)
+{
+  std::mt19937 generator(17);
+  std::uniform_real_distribution<double> size(0.5, 5);
+  std::uniform_real_distribution<double> coordinate(-20, 20);
+  std::uniform_real_distribution<double> angle(0, 180);
+
+  grechin::CompositeShape arr;
+  for (size_t i = 0; i < 400; i++)
+  {
+    const grechin::point_t center = { coordinate(generator), coordinate(generator) };
+    if (i % 2 == 0)
+    {
+      arr.add(std::make_shared<grechin::Circle>(size(generator) / 2, center));
+    }
+    else
+    {
+      arr.add(std::make_shared<grechin::Rectangle>(size(generator), size(generator), center, angle(generator)));
+    }
+  }
+
+  const grechin::union_area_t coarse = arr.getUnionArea(0.01);
+  const grechin::union_area_t fine = arr.getUnionArea(1e-9);
+
+  BOOST_CHECK(coarse.error <= 0.01 * coarse.area);
+  BOOST_CHECK(fine.error <= 1e-9 * fine.area);
+  BOOST_CHECK(fabs(coarse.area - fine.area) <= coarse.error + fine.error);
+  BOOST_CHECK(fine.area < arr.getArea());
+
+  grechin::execution_policy_t policy = arr.getExecutionPolicy();
+  policy.parallel = true;
+  policy.threshold = 0;
+  policy.threads = 4;
+  arr.setExecutionPolicy(policy);
+  const grechin::union_area_t parallel = arr.getUnionArea(1e-9);
+
+  BOOST_CHECK_EQUAL(parallel.area, fine.area);
+  BOOST_CHECK_EQUAL(parallel.error, fine.error);
+  BOOST_CHECK_THROW(arr.getUnionArea(-1), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(nested_test)
+{
+  std::shared_ptr<grechin::Circle> shared = std::make_shared<grechin::Circle>(1, grechin::point_t{ 5, 5 });
+  std::shared_ptr<grechin::CompositeShape> nested = std::make_shared<grechin::CompositeShape>();
+  nested->add(shared);
+  nested->add(std::make_shared<grechin::Rectangle>(2, 4, grechin::point_t{ -5, 0 }));
+
+  grechin::CompositeShape arr;
+  arr.add(nested);
+  arr.add(shared);
+  arr.add(nested);
+
+  BOOST_CHECK_CLOSE(arr.getUnionArea(), M_PI + 8, EPSILON);
+}
+
+BOOST_AUTO_TEST_CASE(intersection_area_test)
+{
+  const grechin::rectangle_t frame = { 2, 2, { 1, 1 } };
+  const grechin::collider_t circle = { grechin::collider_t::circle, { 0, 0 }, 1, 1, { 1, 0 } };
+  const grechin::collider_t box = { grechin::collider_t::box, { 0, 0 }, 1, 1, addition::getRotation(45) };
+
+  BOOST_CHECK_CLOSE(addition::getIntersectionArea(circle, frame), M_PI / 4, EPSILON);
+  BOOST_CHECK_CLOSE(addition::getIntersectionArea(box, frame), 1, EPSILON);
+  BOOST_CHECK_EQUAL(addition::getIntersectionArea(circle, { 1, 1, { 5, 5 } }), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,201 @@
+#include "text-import.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <charconv>
+#include <istream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "composite-shape.hpp"
+#include "shape-store.hpp"
+#include "base-types.hpp"
+
+namespace
+{
+  const size_t MAX_VALUES = 5;
+
+  struct line_t
+  {
+    bool circle;
+    size_t count;
+    double values[MAX_VALUES];
+  };
+
+  [[noreturn]] void throwLineError(const size_t line, const char* message)
+  {
+    throw std::invalid_argument("Line " + std::to_string(line) + ": " + message);
+  }
+
+  bool isSpace(const char symbol)
+  {
+    return symbol == ' ' || symbol == '\t' || symbol == '\r';
+  }
+
+  const char* skipSpaces(const char* begin, const char* end)
+  {
+    while (begin != end && isSpace(*begin))
+    {
+      begin++;
+    }
+    return begin;
+  }
+
+  bool matchKeyword(const char* begin, const char* end, const char* keyword)
+  {
+    const size_t length = std::strlen(keyword);
+    return static_cast<size_t>(end - begin) == length && std::memcmp(begin, keyword, length) == 0;
+  }
+
+  bool parseLine(const char* begin, const char* end, const size_t line, line_t& result)
+  {
+    begin = skipSpaces(begin, end);
+    if (begin == end)
+    {
+      return false;
+    }
+
+    const char* keyword = begin;
+    while (begin != end && !isSpace(*begin))
+    {
+      begin++;
+    }
+    if (matchKeyword(keyword, begin, "CIRCLE"))
+    {
+      result.circle = true;
+    }
+    else if (matchKeyword(keyword, begin, "RECTANGLE"))
+    {
+      result.circle = false;
+    }
+    else
+    {
+      throwLineError(line, "Unknown shape type");
+    }
+
+    result.count = 0;
+    while ((begin = skipSpaces(begin, end)) != end)
+    {
+      if (result.count == MAX_VALUES)
+      {
+        throwLineError(line, "Too many values");
+      }
+      double& value = result.values[result.count++];
+      const std::from_chars_result parsed = std::from_chars(begin, end, value);
+      if (parsed.ec != std::errc() || (parsed.ptr != end && !isSpace(*parsed.ptr)) || !std::isfinite(value))
+      {
+        throwLineError(line, "Invalid number");
+      }
+      begin = parsed.ptr;
+    }
+
+    if (result.circle)
+    {
+      if (result.count != 3)
+      {
+        throwLineError(line, "CIRCLE expects radius, x and y");
+      }
+      if (result.values[0] <= 0)
+      {
+        throwLineError(line, "Radius must be > 0");
+      }
+    }
+    else
+    {
+      if (result.count != 4 && result.count != 5)
+      {
+        throwLineError(line, "RECTANGLE expects width, height, x, y and optional angle");
+      }
+      if (result.values[0] <= 0 || result.values[1] <= 0)
+      {
+        throwLineError(line, "Width and height must be > 0");
+      }
+      if (result.count == 4)
+      {
+        result.values[4] = 0;
+      }
+    }
+    return true;
+  }
+
+  template <typename Sink>
+  size_t parseText(std::istream& in, Sink sink)
+  {
+    std::vector<char> buffer(grechin::TEXT_IMPORT_CHUNK_SIZE);
+    size_t filled = 0;
+    size_t line = 0;
+    size_t count = 0;
+    line_t result = {};
+
+    while (true)
+    {
+      in.read(buffer.data() + filled, buffer.size() - filled);
+      filled += static_cast<size_t>(in.gcount());
+      const bool last = !in;
+      if (in.bad())
+      {
+        throw std::invalid_argument("Cannot read shape data");
+      }
+
+      const char* begin = buffer.data();
+      const char* end = begin + filled;
+      while (const char* next = static_cast<const char*>(std::memchr(begin, '\n', end - begin)))
+      {
+        if (parseLine(begin, next, ++line, result))
+        {
+          sink(result);
+          count++;
+        }
+        begin = next + 1;
+      }
+
+      const size_t remaining = end - begin;
+      if (last)
+      {
+        if (remaining != 0 && parseLine(begin, end, ++line, result))
+        {
+          sink(result);
+          count++;
+        }
+        return count;
+      }
+      if (remaining == buffer.size())
+      {
+        throwLineError(line + 1, "Line is too long");
+      }
+      std::memmove(buffer.data(), begin, remaining);
+      filled = remaining;
+    }
+  }
+}
+
+size_t grechin::importText(std::istream& in, CompositeShape& composite)
+{
+  return parseText(in, [&composite](const line_t& shape)
+  {
+    if (shape.circle)
+    {
+      composite.emplaceCircle(shape.values[0], { shape.values[1], shape.values[2] });
+    }
+    else
+    {
+      composite.emplaceRectangle(shape.values[0], shape.values[1], { shape.values[2], shape.values[3] },
+          shape.values[4]);
+    }
+  });
+}
+
+size_t grechin::importText(std::istream& in, ShapeStore& store)
+{
+  return parseText(in, [&store](const line_t& shape)
+  {
+    if (shape.circle)
+    {
+      store.addCircle(shape.values[0], { shape.values[1], shape.values[2] });
+    }
+    else
+    {
+      store.addRectangle(shape.values[0], shape.values[1], { shape.values[2], shape.values[3] }, shape.values[4]);
+    }
+  });
+}
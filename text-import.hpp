@@ -0,0 +1,18 @@
+#ifndef TEXT_IMPORT_HPP
+#define TEXT_IMPORT_HPP
+
+#include <cstddef>
+#include <iosfwd>
+
+namespace grechin
+{
+  class CompositeShape;
+  class ShapeStore;
+
+  const size_t TEXT_IMPORT_CHUNK_SIZE = 1 << 16;
+
+  size_t importText(std::istream&, CompositeShape&);
+  size_t importText(std::istream&, ShapeStore&);
+}
+
+#endif
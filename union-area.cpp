@@ -0,0 +1,559 @@
+#include "union-area.hpp"
+
+#define _USE_MATH_DEFINES
+
+#include <cmath>
+#include <cstdint>
+#include <atomic>
+#include <stdexcept>
+#include <algorithm>
+
+namespace
+{
+  using grechin::collider_t;
+  using grechin::point_t;
+
+  struct box_t
+  {
+    double xMin;
+    double yMin;
+    double xMax;
+    double yMax;
+  };
+
+  struct cell_t
+  {
+    box_t box;
+    size_t begin;
+    size_t end;
+    double lower;
+    double upper;
+  };
+
+  struct tile_t
+  {
+    std::vector<cell_t> cells;
+    std::vector<size_t> indices;
+    std::vector<cell_t> nextCells;
+    std::vector<size_t> nextIndices;
+    double area;
+    double lower;
+    double upper;
+  };
+
+  const size_t INITIAL_DEPTH = 8;
+  const size_t DEPTH_STEP = 4;
+  const size_t EXACT_SHAPES = 4;
+  const size_t PAIRWISE_SHAPES = 16;
+  const size_t MAX_POLYGON = 4 + 4 * EXACT_SHAPES;
+  const size_t MAX_ARCS = 2 * (MAX_POLYGON + EXACT_SHAPES);
+
+  double getBoxArea(const box_t& box)
+  {
+    return (box.xMax - box.xMin) * (box.yMax - box.yMin);
+  }
+
+  box_t getBounds(const collider_t& shape)
+  {
+    const double width = shape.halfWidth * fabs(shape.rotation.cos) + shape.halfHeight * fabs(shape.rotation.sin);
+    const double height = shape.halfWidth * fabs(shape.rotation.sin) + shape.halfHeight * fabs(shape.rotation.cos);
+    return box_t{ shape.pos.x - width, shape.pos.y - height, shape.pos.x + width, shape.pos.y + height };
+  }
+
+  bool isInside(const collider_t& shape, const double x, const double y)
+  {
+    const double dx = x - shape.pos.x;
+    const double dy = y - shape.pos.y;
+    if (shape.kind == collider_t::circle)
+    {
+      return dx * dx + dy * dy <= shape.halfWidth * shape.halfWidth;
+    }
+    return fabs(dx * shape.rotation.cos + dy * shape.rotation.sin) <= shape.halfWidth
+        && fabs(dy * shape.rotation.cos - dx * shape.rotation.sin) <= shape.halfHeight;
+  }
+
+  bool isCovered(const collider_t& shape, const box_t& box)
+  {
+    return isInside(shape, box.xMin, box.yMin) && isInside(shape, box.xMax, box.yMin)
+        && isInside(shape, box.xMax, box.yMax) && isInside(shape, box.xMin, box.yMax);
+  }
+
+  bool isLess(const collider_t& lhs, const collider_t& rhs)
+  {
+    const double left[] = { lhs.pos.x, lhs.pos.y, lhs.halfWidth, lhs.halfHeight, lhs.rotation.cos, lhs.rotation.sin };
+    const double right[] = { rhs.pos.x, rhs.pos.y, rhs.halfWidth, rhs.halfHeight, rhs.rotation.cos, rhs.rotation.sin };
+    if (lhs.kind != rhs.kind)
+    {
+      return lhs.kind < rhs.kind;
+    }
+    return std::lexicographical_compare(left, left + 6, right, right + 6);
+  }
+
+  bool isEqual(const collider_t& lhs, const collider_t& rhs)
+  {
+    return !isLess(lhs, rhs) && !isLess(rhs, lhs);
+  }
+
+  size_t clipPolygon(const point_t* input, const size_t count, point_t* output, const double x, const double y,
+      const double bound)
+  {
+    size_t result = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+      const point_t& current = input[i];
+      const point_t& next = input[(i + 1) % count];
+      const double currentValue = current.x * x + current.y * y - bound;
+      const double nextValue = next.x * x + next.y * y - bound;
+      if (currentValue <= 0)
+      {
+        output[result++] = current;
+      }
+      if ((currentValue <= 0) != (nextValue <= 0))
+      {
+        const double ratio = currentValue / (currentValue - nextValue);
+        output[result++] = { current.x + (next.x - current.x) * ratio, current.y + (next.y - current.y) * ratio };
+      }
+    }
+    return result;
+  }
+
+  size_t clipBox(point_t* polygon, const size_t count, const collider_t& shape)
+  {
+    point_t clipped[MAX_POLYGON] = {};
+    const double cosAngle = shape.rotation.cos;
+    const double sinAngle = shape.rotation.sin;
+    const double x = shape.pos.x * cosAngle + shape.pos.y * sinAngle;
+    const double y = shape.pos.y * cosAngle - shape.pos.x * sinAngle;
+    size_t result = clipPolygon(polygon, count, clipped, cosAngle, sinAngle, x + shape.halfWidth);
+    result = clipPolygon(clipped, result, polygon, -cosAngle, -sinAngle, shape.halfWidth - x);
+    result = clipPolygon(polygon, result, clipped, -sinAngle, cosAngle, y + shape.halfHeight);
+    result = clipPolygon(clipped, result, polygon, sinAngle, -cosAngle, shape.halfHeight - y);
+    return result;
+  }
+
+  struct arc_t
+  {
+    double begin;
+    double end;
+  };
+
+  size_t intersectArcs(arc_t* arcs, const size_t count, const double center, const double limit)
+  {
+    if (limit >= 1)
+    {
+      return count;
+    }
+    if (limit <= -1)
+    {
+      return 0;
+    }
+    const double width = std::acos(limit);
+    double begin = std::fmod(center + width, 2 * M_PI);
+    begin = (begin < 0) ? begin + 2 * M_PI : begin;
+    const double end = begin + 2 * (M_PI - width);
+    const arc_t parts[2] = { { begin, std::min(end, 2 * M_PI) }, { 0, std::max(end - 2 * M_PI, 0.0) } };
+
+    arc_t result[MAX_ARCS] = {};
+    size_t size = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+      for (const arc_t& part : parts)
+      {
+        const double left = std::max(arcs[i].begin, part.begin);
+        const double right = std::min(arcs[i].end, part.end);
+        if (left < right && size < MAX_ARCS)
+        {
+          result[size++] = { left, right };
+        }
+      }
+    }
+    std::copy(result, result + size, arcs);
+    return size;
+  }
+
+  double getArcArea(const collider_t& circle, const point_t* polygon, const size_t count,
+      const collider_t* const* circles, const size_t circleCount)
+  {
+    const double radius = circle.halfWidth;
+    arc_t arcs[MAX_ARCS] = { { 0, 2 * M_PI } };
+    size_t size = 1;
+    for (size_t i = 0; i < count && size != 0; i++)
+    {
+      const point_t& current = polygon[i];
+      const point_t& next = polygon[(i + 1) % count];
+      const double x = next.y - current.y;
+      const double y = current.x - next.x;
+      const double length = std::sqrt(x * x + y * y);
+      if (length == 0)
+      {
+        continue;
+      }
+      const double bound = x * current.x + y * current.y;
+      const double limit = (bound - x * circle.pos.x - y * circle.pos.y) / (radius * length);
+      size = intersectArcs(arcs, size, std::atan2(y, x), limit);
+    }
+    for (size_t i = 0; i < circleCount && size != 0; i++)
+    {
+      if (circles[i] == &circle)
+      {
+        continue;
+      }
+      const double x = circle.pos.x - circles[i]->pos.x;
+      const double y = circle.pos.y - circles[i]->pos.y;
+      const double distance = std::sqrt(x * x + y * y);
+      const double other = circles[i]->halfWidth;
+      if (distance == 0)
+      {
+        size = (radius <= other) ? size : 0;
+        continue;
+      }
+      const double limit = (other * other - radius * radius - distance * distance) / (2 * radius * distance);
+      size = intersectArcs(arcs, size, std::atan2(y, x), limit);
+    }
+
+    double area = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+      const double begin = arcs[i].begin;
+      const double end = arcs[i].end;
+      area += radius * radius * (end - begin) + radius * circle.pos.x * (std::sin(end) - std::sin(begin))
+          - radius * circle.pos.y * (std::cos(end) - std::cos(begin));
+    }
+    return area / 2;
+  }
+
+  double getEdgeArea(const point_t& current, const point_t& next, const collider_t* const* circles,
+      const size_t circleCount)
+  {
+    double begin = 0;
+    double end = 1;
+    const double dx = next.x - current.x;
+    const double dy = next.y - current.y;
+    const double a = dx * dx + dy * dy;
+    for (size_t i = 0; i < circleCount && begin < end; i++)
+    {
+      const double x = current.x - circles[i]->pos.x;
+      const double y = current.y - circles[i]->pos.y;
+      const double b = x * dx + y * dy;
+      const double c = x * x + y * y - circles[i]->halfWidth * circles[i]->halfWidth;
+      const double discriminant = b * b - a * c;
+      if (a == 0 || discriminant <= 0)
+      {
+        end = (a == 0 && c <= 0) ? end : begin;
+        continue;
+      }
+      const double root = std::sqrt(discriminant);
+      begin = std::max(begin, (-b - root) / a);
+      end = std::min(end, (-b + root) / a);
+    }
+    if (begin >= end)
+    {
+      return 0;
+    }
+    const point_t left = { current.x + dx * begin, current.y + dy * begin };
+    const point_t right = { current.x + dx * end, current.y + dy * end };
+    return (left.x * right.y - left.y * right.x) / 2;
+  }
+
+  double getRegionArea(const point_t* polygon, const size_t count, const collider_t* const* circles,
+      const size_t circleCount)
+  {
+    double area = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+      area += getEdgeArea(polygon[i], polygon[(i + 1) % count], circles, circleCount);
+    }
+    for (size_t i = 0; i < circleCount; i++)
+    {
+      area += getArcArea(*circles[i], polygon, count, circles, circleCount);
+    }
+    return area;
+  }
+
+  size_t getCellPolygon(const box_t& box, point_t* polygon)
+  {
+    polygon[0] = { box.xMin, box.yMin };
+    polygon[1] = { box.xMax, box.yMin };
+    polygon[2] = { box.xMax, box.yMax };
+    polygon[3] = { box.xMin, box.yMax };
+    return 4;
+  }
+
+  double getIntersectionArea(const collider_t* const* shapes, const size_t count, const box_t& box)
+  {
+    if (count == 1)
+    {
+      const box_t bounds = getBounds(*shapes[0]);
+      if (bounds.xMin >= box.xMin && bounds.yMin >= box.yMin && bounds.xMax <= box.xMax && bounds.yMax <= box.yMax)
+      {
+        const double area = 4 * shapes[0]->halfWidth * shapes[0]->halfHeight;
+        return (shapes[0]->kind == collider_t::circle) ? M_PI * area / 4 : area;
+      }
+    }
+    point_t polygon[MAX_POLYGON] = {};
+    size_t size = getCellPolygon(box, polygon);
+    const collider_t* circles[EXACT_SHAPES] = {};
+    size_t circleCount = 0;
+    for (size_t i = 0; i < count && size >= 3; i++)
+    {
+      if (shapes[i]->kind == collider_t::circle)
+      {
+        circles[circleCount++] = shapes[i];
+      }
+      else
+      {
+        size = clipBox(polygon, size, *shapes[i]);
+      }
+    }
+    if (size < 3)
+    {
+      return 0;
+    }
+    return std::max(getRegionArea(polygon, size, circles, circleCount), 0.0);
+  }
+
+  void getContacts(const std::vector<collider_t>& colliders, const size_t* indices, const size_t count,
+      uint32_t* contacts)
+  {
+    std::fill(contacts, contacts + count, 0);
+    for (size_t i = 0; i < count; i++)
+    {
+      for (size_t j = i + 1; j < count; j++)
+      {
+        if (addition::isIntersected(colliders[indices[i]], colliders[indices[j]]))
+        {
+          contacts[i] |= uint32_t(1) << j;
+          contacts[j] |= uint32_t(1) << i;
+        }
+      }
+    }
+  }
+
+  double getUnionArea(const std::vector<collider_t>& colliders, const size_t* indices, const size_t count,
+      const uint32_t* contacts, const box_t& box)
+  {
+    double area = 0;
+    for (uint32_t mask = 1; mask < (uint32_t(1) << count); mask++)
+    {
+      const collider_t* shapes[EXACT_SHAPES] = {};
+      size_t size = 0;
+      bool empty = false;
+      for (size_t i = 0; i < count && !empty; i++)
+      {
+        if (mask & (uint32_t(1) << i))
+        {
+          shapes[size++] = &colliders[indices[i]];
+          empty = (mask & ~contacts[i] & ~(uint32_t(1) << i)) != 0;
+        }
+      }
+      if (!empty)
+      {
+        area += (size % 2 == 1 ? 1 : -1) * getIntersectionArea(shapes, size, box);
+      }
+    }
+    return area;
+  }
+
+  void refine(const std::vector<collider_t>& colliders, std::vector<size_t>& scratch, const size_t begin,
+      const size_t end, const box_t& box, const size_t depth, tile_t& tile)
+  {
+    const size_t first = scratch.size();
+    const double boxArea = getBoxArea(box);
+    const collider_t cell = { collider_t::box, { (box.xMin + box.xMax) / 2, (box.yMin + box.yMax) / 2 },
+        (box.xMax - box.xMin) / 2, (box.yMax - box.yMin) / 2, { 1, 0 } };
+    for (size_t i = begin; i < end; i++)
+    {
+      const size_t index = scratch[i];
+      if (isCovered(colliders[index], box))
+      {
+        scratch.resize(first);
+        tile.area += boxArea;
+        return;
+      }
+      if (addition::isIntersected(colliders[index], cell))
+      {
+        scratch.push_back(index);
+      }
+    }
+
+    uint32_t contacts[PAIRWISE_SHAPES] = {};
+    bool exact = false;
+    if (scratch.size() - first <= PAIRWISE_SHAPES)
+    {
+      getContacts(colliders, scratch.data() + first, scratch.size() - first, contacts);
+      size_t kept = first;
+      for (size_t i = first; i < scratch.size(); i++)
+      {
+        if (contacts[i - first] == 0)
+        {
+          const collider_t* shape = &colliders[scratch[i]];
+          tile.area += getIntersectionArea(&shape, 1, box);
+        }
+        else
+        {
+          scratch[kept++] = scratch[i];
+        }
+      }
+      if (kept != scratch.size())
+      {
+        scratch.resize(kept);
+        getContacts(colliders, scratch.data() + first, kept - first, contacts);
+      }
+      exact = kept - first <= EXACT_SHAPES;
+    }
+
+    const size_t last = scratch.size();
+    if (last != first && exact)
+    {
+      tile.area += getUnionArea(colliders, scratch.data() + first, last - first, contacts, box);
+    }
+    else if (last != first && depth == 0)
+    {
+      double lower = 0;
+      double upper = 0;
+      for (size_t i = first; i < last; i++)
+      {
+        const collider_t* shape = &colliders[scratch[i]];
+        const double area = getIntersectionArea(&shape, 1, box);
+        lower = std::max(lower, area);
+        upper += area;
+      }
+      upper = std::min(upper, boxArea);
+      tile.nextCells.push_back({ box, tile.nextIndices.size(), tile.nextIndices.size() + last - first, lower, upper });
+      tile.nextIndices.insert(tile.nextIndices.end(), scratch.begin() + first, scratch.end());
+    }
+    else if (last != first)
+    {
+      const double x = (box.xMin + box.xMax) / 2;
+      const double y = (box.yMin + box.yMax) / 2;
+      refine(colliders, scratch, first, last, { box.xMin, box.yMin, x, y }, depth - 1, tile);
+      refine(colliders, scratch, first, last, { x, box.yMin, box.xMax, y }, depth - 1, tile);
+      refine(colliders, scratch, first, last, { box.xMin, y, x, box.yMax }, depth - 1, tile);
+      refine(colliders, scratch, first, last, { x, y, box.xMax, box.yMax }, depth - 1, tile);
+    }
+    scratch.resize(first);
+  }
+
+  void refineTile(const std::vector<collider_t>& colliders, const size_t depth, tile_t& tile)
+  {
+    std::vector<size_t> scratch;
+    tile.nextCells.clear();
+    tile.nextIndices.clear();
+    for (const cell_t& cell : tile.cells)
+    {
+      scratch.assign(tile.indices.begin() + cell.begin, tile.indices.begin() + cell.end);
+      refine(colliders, scratch, 0, scratch.size(), cell.box, depth, tile);
+    }
+    tile.cells.swap(tile.nextCells);
+    tile.indices.swap(tile.nextIndices);
+    tile.lower = 0;
+    tile.upper = 0;
+    for (const cell_t& cell : tile.cells)
+    {
+      tile.lower += cell.lower;
+      tile.upper += cell.upper;
+    }
+  }
+}
+
+grechin::union_area_t grechin::getUnionArea(const std::vector<collider_t>& shapes, const double tolerance,
+    const execution_policy_t& policy)
+{
+  if (!(tolerance >= 0))
+  {
+    throw std::invalid_argument("Invalid tolerance");
+  }
+  std::vector<collider_t> colliders = shapes;
+  std::sort(colliders.begin(), colliders.end(), isLess);
+  colliders.erase(std::unique(colliders.begin(), colliders.end(), isEqual), colliders.end());
+  if (colliders.empty())
+  {
+    return union_area_t{ 0, 0 };
+  }
+
+  box_t bounds = getBounds(colliders.front());
+  for (const collider_t& shape : colliders)
+  {
+    const box_t box = getBounds(shape);
+    bounds = { std::min(bounds.xMin, box.xMin), std::min(bounds.yMin, box.yMin), std::max(bounds.xMax, box.xMax),
+        std::max(bounds.yMax, box.yMax) };
+  }
+  if (getBoxArea(bounds) <= 0)
+  {
+    return union_area_t{ 0, 0 };
+  }
+
+  const size_t count = UNION_AREA_TILES;
+  const double width = (bounds.xMax - bounds.xMin) / count;
+  const double height = (bounds.yMax - bounds.yMin) / count;
+  std::vector<tile_t> tiles(count * count);
+  for (size_t i = 0; i < colliders.size(); i++)
+  {
+    const box_t box = getBounds(colliders[i]);
+    const size_t xFirst = std::min<size_t>((box.xMin - bounds.xMin) / width, count - 1);
+    const size_t xLast = std::min<size_t>((box.xMax - bounds.xMin) / width, count - 1);
+    const size_t yFirst = std::min<size_t>((box.yMin - bounds.yMin) / height, count - 1);
+    const size_t yLast = std::min<size_t>((box.yMax - bounds.yMin) / height, count - 1);
+    for (size_t y = yFirst; y <= yLast; y++)
+    {
+      for (size_t x = xFirst; x <= xLast; x++)
+      {
+        tiles[y * count + x].indices.push_back(i);
+      }
+    }
+  }
+  for (size_t y = 0; y < count; y++)
+  {
+    for (size_t x = 0; x < count; x++)
+    {
+      tile_t& tile = tiles[y * count + x];
+      const box_t box = { bounds.xMin + x * width, bounds.yMin + y * height,
+          (x + 1 == count) ? bounds.xMax : bounds.xMin + (x + 1) * width,
+          (y + 1 == count) ? bounds.yMax : bounds.yMin + (y + 1) * height };
+      tile.cells.push_back({ box, 0, tile.indices.size(), 0, getBoxArea(box) });
+      tile.area = 0;
+    }
+  }
+
+  const size_t threads = parallel::getThreadCount(policy, colliders.size());
+  size_t depth = 0;
+  size_t step = INITIAL_DEPTH;
+  while (true)
+  {
+    std::atomic<size_t> next(0);
+    parallel::forEachChunk(threads, threads, [&colliders, &tiles, &next, step](const size_t, const size_t, const size_t)
+    {
+      for (size_t i = next++; i < tiles.size(); i = next++)
+      {
+        refineTile(colliders, step, tiles[i]);
+      }
+    });
+    depth += step;
+    step = DEPTH_STEP;
+
+    double area = 0;
+    double lower = 0;
+    double upper = 0;
+    bool pending = false;
+    for (const tile_t& tile : tiles)
+    {
+      area += tile.area;
+      lower += tile.lower;
+      upper += tile.upper;
+      pending = pending || !tile.cells.empty();
+    }
+    const union_area_t result = { area + (lower + upper) / 2, (upper - lower) / 2 };
+    if (!pending || result.error <= tolerance * result.area || depth >= UNION_AREA_MAX_DEPTH)
+    {
+      return result;
+    }
+  }
+}
+
+double addition::getIntersectionArea(const grechin::collider_t& shape, const grechin::rectangle_t& frame)
+{
+  const box_t box = { frame.pos.x - frame.width / 2, frame.pos.y - frame.height / 2, frame.pos.x + frame.width / 2,
+      frame.pos.y + frame.height / 2 };
+  const collider_t* shapes[] = { &shape };
+  return ::getIntersectionArea(shapes, 1, box);
+}
@@ -0,0 +1,30 @@
+#ifndef UNION_AREA_HPP
+#define UNION_AREA_HPP
+
+#include <cstddef>
+#include <vector>
+#include "base-types.hpp"
+#include "parallel.hpp"
+#include "narrow-phase.hpp"
+
+namespace grechin
+{
+  struct union_area_t
+  {
+    double area;
+    double error;
+  };
+
+  const double UNION_AREA_TOLERANCE = 1e-9;
+  const size_t UNION_AREA_TILES = 16;
+  const size_t UNION_AREA_MAX_DEPTH = 40;
+
+  union_area_t getUnionArea(const std::vector<collider_t>&, const double, const execution_policy_t&);
+}
+
+namespace addition
+{
+  double getIntersectionArea(const grechin::collider_t&, const grechin::rectangle_t&);
+}
+
+#endif